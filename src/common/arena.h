@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+#include "common/alignment.h"
+#include "common/types.h"
+
+namespace Common {
+
+/**
+ * Monotonic memory resource for data that dies all at once. Allocations bump a pointer within
+ * a chunk and deallocations do nothing. Reset rewinds to the first chunk without returning any
+ * memory, so a workload that repeats settles on a fixed set of chunks and stops touching the
+ * heap. Not thread safe, each thread that allocates needs its own arena.
+ */
+class MonotonicArena final : public std::pmr::memory_resource {
+public:
+    struct Stats {
+        u64 num_allocations{};       ///< Allocations served since the last reset.
+        u64 bytes_allocated{};       ///< Bytes handed out since the last reset.
+        u64 num_chunk_allocations{}; ///< Chunks taken from the heap since the last reset.
+    };
+
+    explicit MonotonicArena(size_t chunk_size_ = 64_KB) : chunk_size{chunk_size_} {}
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    /// Invalidates everything allocated from the arena. Objects are not destroyed.
+    void Reset() noexcept {
+        current = 0;
+        offset = 0;
+        stats = {};
+    }
+
+    [[nodiscard]] const Stats& GetStats() const noexcept {
+        return stats;
+    }
+
+private:
+    struct Chunk {
+        std::unique_ptr<std::byte[]> data;
+        size_t size;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++stats.num_allocations;
+        stats.bytes_allocated += bytes;
+        if (!chunks.empty()) {
+            if (void* ptr = TryAllocate(chunks[current], bytes, alignment)) {
+                return ptr;
+            }
+        }
+        // Chunks past the current one are unused since the last reset. Take the first that is
+        // large enough and move it right after the current one, so oversized chunks are found
+        // again on the next round instead of being skipped.
+        const size_t next = chunks.empty() ? 0 : current + 1;
+        const auto fits = [&](const Chunk& chunk) { return chunk.size >= bytes + alignment; };
+        const auto it = std::find_if(chunks.begin() + next, chunks.end(), fits);
+        if (it != chunks.end()) {
+            std::rotate(chunks.begin() + next, it, it + 1);
+        } else {
+            ++stats.num_chunk_allocations;
+            const size_t size = std::max(chunk_size, bytes + alignment);
+            chunks.insert(chunks.begin() + next, Chunk{std::make_unique<std::byte[]>(size), size});
+        }
+        current = next;
+        offset = 0;
+        return TryAllocate(chunks[current], bytes, alignment);
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void* TryAllocate(Chunk& chunk, size_t bytes, size_t alignment) noexcept {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(chunk.data.get());
+        const uintptr_t start = AlignUp(base + offset, alignment);
+        if (start + bytes > base + chunk.size) {
+            return nullptr;
+        }
+        offset = start + bytes - base;
+        return reinterpret_cast<void*>(start);
+    }
+
+    std::vector<Chunk> chunks;
+    size_t current{};
+    size_t offset{};
+    size_t chunk_size;
+    Stats stats;
+};
+
+} // namespace Common
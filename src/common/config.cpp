@@ -31,6 +31,7 @@ std::filesystem::path find_fs_path_or(const basic_value<TC>& v, const K& ky,
 namespace Config {
 
 static bool isNeo = false;
+static bool hugePages = false;
 static bool isFullscreen = false;
 static bool playBGM = false;
 static int BGMvolume = 50;
@@ -46,11 +47,20 @@ static std::string backButtonBehavior = "left";
 static bool useSpecialPad = false;
 static int specialPadClass = 1;
 static bool isDebugDump = false;
+static bool memoryTrace = false;
 static bool isShowSplash = false;
 static bool isAutoUpdate = false;
 static bool isNullGpu = false;
 static bool shouldCopyGPUBuffers = false;
 static bool shouldDumpShaders = false;
+static bool shaderCacheEnabled = true;
+static u32 pipelineThreads = 0; // Zero compiles pipelines on the GPU thread
+static bool skipPendingDraws = true;
+static bool hostDetiling = true;
+static bool parallelCompute = false;
+static u32 vramBudgetPercent = 90; // Zero disables eviction of cached GPU resources
+static bool parallelRecording = false;
+static std::vector<std::string> disabledShaderPasses; // Names of optional shader IR passes
 static u32 vblankDivider = 1;
 static bool vkValidation = false;
 static bool vkValidationSync = false;
@@ -88,6 +98,10 @@ bool isNeoMode() {
     return isNeo;
 }
 
+bool isHugePagesEnabled() {
+    return hugePages;
+}
+
 bool isFullscreenMode() {
     return isFullscreen;
 }
@@ -156,6 +170,10 @@ bool debugDump() {
     return isDebugDump;
 }
 
+bool isMemoryTraceEnabled() {
+    return memoryTrace;
+}
+
 bool showSplash() {
     return isShowSplash;
 }
@@ -176,6 +194,38 @@ bool dumpShaders() {
     return shouldDumpShaders;
 }
 
+bool isShaderCacheEnabled() {
+    return shaderCacheEnabled;
+}
+
+u32 pipelineCompileThreads() {
+    return pipelineThreads;
+}
+
+bool skipPendingPipelineDraws() {
+    return skipPendingDraws;
+}
+
+bool isHostDetilingEnabled() {
+    return hostDetiling;
+}
+
+bool isParallelComputeEnabled() {
+    return parallelCompute;
+}
+
+u32 getVramBudgetPercent() {
+    return vramBudgetPercent;
+}
+
+bool isParallelRecordingEnabled() {
+    return parallelRecording;
+}
+
+const std::vector<std::string>& getDisabledShaderPasses() {
+    return disabledShaderPasses;
+}
+
 bool isRdocEnabled() {
     return rdocEnable;
 }
@@ -228,6 +278,10 @@ void setDebugDump(bool enable) {
     isDebugDump = enable;
 }
 
+void setMemoryTraceEnabled(bool enable) {
+    memoryTrace = enable;
+}
+
 void setShowSplash(bool enable) {
     isShowSplash = enable;
 }
@@ -248,6 +302,34 @@ void setDumpShaders(bool enable) {
     shouldDumpShaders = enable;
 }
 
+void setShaderCacheEnabled(bool enable) {
+    shaderCacheEnabled = enable;
+}
+
+void setPipelineCompileThreads(u32 value) {
+    pipelineThreads = value;
+}
+
+void setSkipPendingPipelineDraws(bool enable) {
+    skipPendingDraws = enable;
+}
+
+void setHostDetilingEnabled(bool enable) {
+    hostDetiling = enable;
+}
+
+void setParallelComputeEnabled(bool enable) {
+    parallelCompute = enable;
+}
+
+void setVramBudgetPercent(u32 value) {
+    vramBudgetPercent = value;
+}
+
+void setParallelRecordingEnabled(bool enable) {
+    parallelRecording = enable;
+}
+
 void setVkValidation(bool enable) {
     vkValidation = enable;
 }
@@ -296,6 +378,10 @@ void setNeoMode(bool enable) {
     isNeo = enable;
 }
 
+void setHugePagesEnabled(bool enable) {
+    hugePages = enable;
+}
+
 void setLogType(const std::string& type) {
     logType = type;
 }
@@ -478,6 +564,7 @@ void load(const std::filesystem::path& path) {
         const toml::value& general = data.at("General");
 
         isNeo = toml::find_or<bool>(general, "isPS4Pro", false);
+        hugePages = toml::find_or<bool>(general, "directMemoryHugePages", false);
         isFullscreen = toml::find_or<bool>(general, "Fullscreen", false);
         playBGM = toml::find_or<bool>(general, "playBGM", false);
         BGMvolume = toml::find_or<int>(general, "BGMvolume", 50);
@@ -513,6 +600,15 @@ void load(const std::filesystem::path& path) {
         isNullGpu = toml::find_or<bool>(gpu, "nullGpu", false);
         shouldCopyGPUBuffers = toml::find_or<bool>(gpu, "copyGPUBuffers", false);
         shouldDumpShaders = toml::find_or<bool>(gpu, "dumpShaders", false);
+        shaderCacheEnabled = toml::find_or<bool>(gpu, "shaderCache", true);
+        pipelineThreads = toml::find_or<int>(gpu, "pipelineCompileThreads", 0);
+        skipPendingDraws = toml::find_or<bool>(gpu, "skipPendingPipelineDraws", true);
+        hostDetiling = toml::find_or<bool>(gpu, "hostDetiling", true);
+        parallelCompute = toml::find_or<bool>(gpu, "parallelComputeQueues", false);
+        vramBudgetPercent = toml::find_or<int>(gpu, "vramBudgetPercent", 90);
+        parallelRecording = toml::find_or<bool>(gpu, "parallelCommandRecording", false);
+        disabledShaderPasses =
+            toml::find_or<std::vector<std::string>>(gpu, "disabledShaderPasses", {});
         vblankDivider = toml::find_or<int>(gpu, "vblankDivider", 1);
     }
 
@@ -532,6 +628,7 @@ void load(const std::filesystem::path& path) {
         const toml::value& debug = data.at("Debug");
 
         isDebugDump = toml::find_or<bool>(debug, "DebugDump", false);
+        memoryTrace = toml::find_or<bool>(debug, "MemoryTrace", false);
     }
 
     if (data.contains("GUI")) {
@@ -597,6 +694,7 @@ void save(const std::filesystem::path& path) {
     }
 
     data["General"]["isPS4Pro"] = isNeo;
+    data["General"]["directMemoryHugePages"] = hugePages;
     data["General"]["Fullscreen"] = isFullscreen;
     data["General"]["playBGM"] = playBGM;
     data["General"]["BGMvolume"] = BGMvolume;
@@ -618,6 +716,14 @@ void save(const std::filesystem::path& path) {
     data["GPU"]["nullGpu"] = isNullGpu;
     data["GPU"]["copyGPUBuffers"] = shouldCopyGPUBuffers;
     data["GPU"]["dumpShaders"] = shouldDumpShaders;
+    data["GPU"]["shaderCache"] = shaderCacheEnabled;
+    data["GPU"]["pipelineCompileThreads"] = pipelineThreads;
+    data["GPU"]["skipPendingPipelineDraws"] = skipPendingDraws;
+    data["GPU"]["hostDetiling"] = hostDetiling;
+    data["GPU"]["parallelComputeQueues"] = parallelCompute;
+    data["GPU"]["vramBudgetPercent"] = vramBudgetPercent;
+    data["GPU"]["parallelCommandRecording"] = parallelRecording;
+    data["GPU"]["disabledShaderPasses"] = disabledShaderPasses;
     data["GPU"]["vblankDivider"] = vblankDivider;
     data["Vulkan"]["gpuId"] = gpuId;
     data["Vulkan"]["validation"] = vkValidation;
@@ -627,6 +733,7 @@ void save(const std::filesystem::path& path) {
     data["Vulkan"]["rdocMarkersEnable"] = vkMarkers;
     data["Vulkan"]["crashDiagnostic"] = vkCrashDiagnostic;
     data["Debug"]["DebugDump"] = isDebugDump;
+    data["Debug"]["MemoryTrace"] = memoryTrace;
     data["GUI"]["theme"] = mw_themes;
     data["GUI"]["iconSize"] = m_icon_size;
     data["GUI"]["sliderPos"] = m_slider_pos;
@@ -665,6 +772,7 @@ void save(const std::filesystem::path& path) {
 
 void setDefaultValues() {
     isNeo = false;
+    hugePages = false;
     isFullscreen = false;
     playBGM = false;
     BGMvolume = 50;
@@ -685,10 +793,19 @@ void setDefaultValues() {
     useSpecialPad = false;
     specialPadClass = 1;
     isDebugDump = false;
+    memoryTrace = false;
     isShowSplash = false;
     isAutoUpdate = false;
     isNullGpu = false;
     shouldDumpShaders = false;
+    shaderCacheEnabled = true;
+    pipelineThreads = 0;
+    skipPendingDraws = true;
+    hostDetiling = true;
+    parallelCompute = false;
+    vramBudgetPercent = 90;
+    parallelRecording = false;
+    disabledShaderPasses.clear();
     vblankDivider = 1;
     vkValidation = false;
     vkValidationSync = false;
@@ -15,6 +15,7 @@ void load(const std::filesystem::path& path);
 void save(const std::filesystem::path& path);
 
 bool isNeoMode();
+bool isHugePagesEnabled();
 bool isFullscreenMode();
 bool getPlayBGM();
 int getBGMvolume();
@@ -37,20 +38,37 @@ u32 getScreenHeight();
 s32 getGpuId();
 
 bool debugDump();
+bool isMemoryTraceEnabled();
 bool showSplash();
 bool autoUpdate();
 bool nullGpu();
 bool copyGPUCmdBuffers();
 bool dumpShaders();
+bool isShaderCacheEnabled();
+u32 pipelineCompileThreads();
+bool skipPendingPipelineDraws();
+bool isHostDetilingEnabled();
+bool isParallelComputeEnabled();
+u32 getVramBudgetPercent();
+bool isParallelRecordingEnabled();
+const std::vector<std::string>& getDisabledShaderPasses();
 bool isRdocEnabled();
 u32 vblankDiv();
 
 void setDebugDump(bool enable);
+void setMemoryTraceEnabled(bool enable);
 void setShowSplash(bool enable);
 void setAutoUpdate(bool enable);
 void setNullGpu(bool enable);
 void setCopyGPUCmdBuffers(bool enable);
 void setDumpShaders(bool enable);
+void setShaderCacheEnabled(bool enable);
+void setPipelineCompileThreads(u32 value);
+void setSkipPendingPipelineDraws(bool enable);
+void setHostDetilingEnabled(bool enable);
+void setParallelComputeEnabled(bool enable);
+void setVramBudgetPercent(u32 value);
+void setParallelRecordingEnabled(bool enable);
 void setVblankDiv(u32 value);
 void setGpuId(s32 selectedGpuId);
 void setScreenWidth(u32 width);
@@ -61,6 +79,7 @@ void setBGMvolume(int volume);
 void setEnableDiscordRPC(bool enable);
 void setLanguage(u32 language);
 void setNeoMode(bool enable);
+void setHugePagesEnabled(bool enable);
 void setUserName(const std::string& type);
 void setUpdateChannel(const std::string& type);
 void setSeparateUpdateEnabled(bool use);
@@ -1,9 +1,16 @@
 // SPDX-FileCopyrightText: Copyright 2014 Citra Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <filesystem>
+#include <memory>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include <fmt/format.h>
 
@@ -16,6 +23,7 @@
 #include "common/debug.h"
 #include "common/io_file.h"
 #include "common/logging/backend.h"
+#include "common/logging/binary_log.h"
 #include "common/logging/log.h"
 #include "common/logging/log_entry.h"
 #include "common/logging/text_formatter.h"
@@ -29,6 +37,19 @@ using namespace Common::FS;
 
 namespace {
 
+/// Formats a deferred entry into a regular one.
+Entry FormatEntry(const BinaryEntry& entry) {
+    return Entry{
+        .timestamp = entry.timestamp,
+        .log_class = entry.log_class,
+        .log_level = entry.log_level,
+        .filename = entry.filename,
+        .line_num = entry.line_num,
+        .function = entry.function,
+        .message = FormatBinaryMessage(entry),
+    };
+}
+
 /**
  * Backend that writes to stderr and with color
  */
@@ -44,6 +65,12 @@ public:
         }
     }
 
+    void Write(const BinaryEntry& entry) {
+        if (enabled.load(std::memory_order_relaxed)) {
+            PrintColoredMessage(FormatEntry(entry));
+        }
+    }
+
     void Flush() {
         // stderr shouldn't be buffered
     }
@@ -57,12 +84,21 @@ private:
 };
 
 /**
- * Backend that writes to a file passed into the constructor
+ * Backend that writes to a file passed into the constructor. In binary mode the file uses the
+ * format of BinaryLogWriter and deferred entries are never formatted.
  */
 class FileBackend {
 public:
-    explicit FileBackend(const std::filesystem::path& filename)
-        : file{filename, FS::FileAccessMode::Write, FS::FileType::TextFile} {}
+    explicit FileBackend(const std::filesystem::path& filename, bool binary_)
+        : binary{binary_} {
+        if (binary) {
+            file.Open(std::filesystem::path{filename}.replace_extension(".bin"),
+                      FS::FileAccessMode::Write);
+            bytes_written += writer.WriteHeader(file);
+        } else {
+            file.Open(filename, FS::FileAccessMode::Write, FS::FileType::TextFile);
+        }
+    }
 
     ~FileBackend() = default;
 
@@ -71,12 +107,38 @@ public:
             return;
         }
 
-        bytes_written += file.WriteString(FormatLogMessage(entry).append(1, '\n'));
+        if (binary) {
+            bytes_written += writer.Write(file, entry);
+        } else {
+            bytes_written += file.WriteString(FormatLogMessage(entry).append(1, '\n'));
+        }
+        OnWrite(entry.log_level);
+    }
+
+    void Write(const BinaryEntry& entry) {
+        if (!enabled) {
+            return;
+        }
+
+        if (binary) {
+            bytes_written += writer.Write(file, entry);
+        } else {
+            bytes_written += file.WriteString(FormatLogMessage(FormatEntry(entry)).append(1, '\n'));
+        }
+        OnWrite(entry.log_level);
+    }
+
+    void Flush() {
+        file.Flush();
+    }
+
+private:
+    void OnWrite(Level log_level) {
 
         // Prevent logs from exceeding a set maximum size in the event that log entries are spammed.
         const auto write_limit = 100_MB;
         const bool write_limit_exceeded = bytes_written > write_limit;
-        if (entry.log_level >= Level::Error || write_limit_exceeded) {
+        if (log_level >= Level::Error || write_limit_exceeded) {
             if (write_limit_exceeded) {
                 // Stop writing after the write limit is exceeded.
                 // Don't close the file so we can print a stacktrace if necessary
@@ -86,12 +148,9 @@ public:
         }
     }
 
-    void Flush() {
-        file.Flush();
-    }
-
-private:
     Common::FS::IOFile file;
+    BinaryLogWriter writer;
+    bool binary;
     bool enabled = true;
     std::size_t bytes_written = 0;
 };
@@ -117,6 +176,54 @@ public:
 };
 
 bool initialization_in_progress_suppress_logging = true;
+bool binary_logging = false;
+
+/**
+ * Lock-free queue of deferred entries with a single producing thread, drained by the backend
+ * thread.
+ */
+class LogRing {
+public:
+    static constexpr size_t Capacity = 256;
+
+    bool TryPush(const BinaryEntry& entry) {
+        const size_t write_index = m_write_index.load(std::memory_order::relaxed);
+        if (write_index - m_read_index.load(std::memory_order::acquire) == Capacity) {
+            return false;
+        }
+        m_data[write_index % Capacity] = entry;
+        m_write_index.store(write_index + 1, std::memory_order::release);
+        return true;
+    }
+
+    bool TryPop(BinaryEntry& entry) {
+        const size_t read_index = m_read_index.load(std::memory_order::relaxed);
+        if (read_index == m_write_index.load(std::memory_order::acquire)) {
+            return false;
+        }
+        entry = m_data[read_index % Capacity];
+        m_read_index.store(read_index + 1, std::memory_order::release);
+        return true;
+    }
+
+    /// Set once the owning thread exits, the backend releases the ring after draining it.
+    std::atomic_bool closed{false};
+
+private:
+    alignas(128) std::atomic_size_t m_read_index{0};
+    alignas(128) std::atomic_size_t m_write_index{0};
+    std::array<BinaryEntry, Capacity> m_data;
+};
+
+struct ThreadRing {
+    ~ThreadRing() {
+        if (ring) {
+            ring->closed.store(true, std::memory_order::release);
+        }
+    }
+
+    std::shared_ptr<LogRing> ring;
+};
 
 /**
  * Static state as a singleton.
@@ -139,6 +246,7 @@ public:
         std::filesystem::create_directory(log_dir);
         Filter filter;
         filter.ParseFilterString(Config::getLogFilter());
+        binary_logging = Config::getLogType() == "binary";
         instance = std::unique_ptr<Impl, decltype(&Deleter)>(new Impl(log_dir / LOG_FILE, filter),
                                                              Deleter);
         initialization_in_progress_suppress_logging = false;
@@ -207,7 +315,11 @@ public:
             .function = function,
             .message = std::move(message),
         };
-        if (Config::getLogType() == "async") {
+        if (binary_logging) {
+            // The backend thread owns the binary writer, so it has to write this entry too.
+            message_queue.EmplaceWait(entry);
+            WakeBackend();
+        } else if (Config::getLogType() == "async") {
             message_queue.EmplaceWait(entry);
         } else {
             ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
@@ -215,15 +327,113 @@ public:
         }
     }
 
+    void PushBinaryEntry(BinaryEntry entry) {
+        // The profiler only receives formatted messages.
+        if (IsProfilerConnected() && entry.log_level >= Level::Warning) {
+            PushEntry(entry.log_class, entry.log_level, entry.filename, entry.line_num,
+                      entry.function, FormatBinaryMessage(entry));
+            return;
+        }
+
+        if (!filter.CheckMessage(entry.log_class, entry.log_level)) {
+            return;
+        }
+
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        using std::chrono::steady_clock;
+
+        entry.timestamp = duration_cast<microseconds>(steady_clock::now() - time_origin);
+        LogRing& ring = GetThreadRing();
+        while (!ring.TryPush(entry)) {
+            if (!backend_running) {
+                return;
+            }
+            WakeBackend();
+            std::this_thread::yield();
+        }
+        if (backend_sleeping.load(std::memory_order::relaxed)) {
+            WakeBackend();
+        }
+    }
+
 private:
     Impl(const std::filesystem::path& file_backend_filename, const Filter& filter_)
-        : filter{filter_}, file_backend{file_backend_filename} {}
+        : filter{filter_}, file_backend{file_backend_filename, binary_logging} {}
 
     ~Impl() = default;
 
+    LogRing& GetThreadRing() {
+        thread_local ThreadRing thread_ring;
+        if (!thread_ring.ring) {
+            thread_ring.ring = std::make_shared<LogRing>();
+            std::scoped_lock lk{rings_mutex};
+            rings.push_back(thread_ring.ring);
+        }
+        return *thread_ring.ring;
+    }
+
+    void WakeBackend() {
+        std::scoped_lock lk{wake_mutex};
+        wake_cv.notify_one();
+    }
+
+    /// Writes out everything queued so far, returns false if there was nothing to write.
+    bool DrainBinaryEntries(std::vector<BinaryEntry>& batch) {
+        bool has_entries = false;
+        Entry entry;
+        while (message_queue.TryPop(entry)) {
+            ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
+            has_entries = true;
+        }
+
+        {
+            std::scoped_lock lk{rings_mutex};
+            BinaryEntry binary_entry;
+            for (auto it = rings.begin(); it != rings.end();) {
+                // Check before draining so entries pushed right before the thread exited are
+                // not lost.
+                const bool closed = (*it)->closed.load(std::memory_order::acquire);
+                while ((*it)->TryPop(binary_entry)) {
+                    batch.push_back(binary_entry);
+                }
+                it = closed ? rings.erase(it) : std::next(it);
+            }
+        }
+
+        // Interleave the messages of all threads in the order they were logged.
+        std::ranges::stable_sort(batch, {}, &BinaryEntry::timestamp);
+        for (const BinaryEntry& binary_entry : batch) {
+            ForEachBackend([&binary_entry](auto& backend) { backend.Write(binary_entry); });
+        }
+        has_entries |= !batch.empty();
+        batch.clear();
+        return has_entries;
+    }
+
+    void BinaryBackendLoop(std::stop_token stop_token) {
+        static constexpr auto IdleTimeout = std::chrono::milliseconds{10};
+        std::vector<BinaryEntry> batch;
+        while (!stop_token.stop_requested()) {
+            if (DrainBinaryEntries(batch)) {
+                continue;
+            }
+            std::unique_lock lk{wake_mutex};
+            backend_sleeping = true;
+            wake_cv.wait_for(lk, IdleTimeout);
+            backend_sleeping = false;
+        }
+        DrainBinaryEntries(batch);
+    }
+
     void StartBackendThread() {
+        backend_running = true;
         backend_thread = std::jthread([this](std::stop_token stop_token) {
             Common::SetCurrentThreadName("shadPS4:Log");
+            if (binary_logging) {
+                BinaryBackendLoop(stop_token);
+                return;
+            }
             Entry entry;
             const auto write_logs = [this, &entry]() {
                 ForEachBackend([&entry](auto& backend) { backend.Write(entry); });
@@ -248,6 +458,7 @@ private:
         if (backend_thread.joinable()) {
             backend_thread.join();
         }
+        backend_running = false;
 
         ForEachBackend([](auto& backend) { backend.Flush(); });
     }
@@ -272,6 +483,13 @@ private:
     MPSCQueue<Entry> message_queue{};
     std::chrono::steady_clock::time_point time_origin{std::chrono::steady_clock::now()};
     std::jthread backend_thread;
+    std::atomic_bool backend_running{false};
+
+    std::mutex rings_mutex;
+    std::vector<std::shared_ptr<LogRing>> rings;
+    std::mutex wake_mutex;
+    std::condition_variable wake_cv;
+    std::atomic_bool backend_sleeping{false};
 };
 } // namespace
 
@@ -299,6 +517,16 @@ void SetColorConsoleBackendEnabled(bool enabled) {
     Impl::Instance().SetColorConsoleBackendEnabled(enabled);
 }
 
+bool IsBinaryLogging() {
+    return binary_logging;
+}
+
+void PushBinaryEntry(const BinaryEntry& entry) {
+    if (!initialization_in_progress_suppress_logging) [[likely]] {
+        Impl::Instance().PushBinaryEntry(entry);
+    }
+}
+
 void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args) {
@@ -0,0 +1,136 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "common/logging/types.h"
+
+namespace Common::Log {
+
+enum class ArgType : u8 {
+    Bool,
+    Char,
+    Int,
+    UInt,
+    Float,
+    Double,
+    Pointer,
+    String,
+};
+
+/**
+ * A log message whose formatting is deferred to the backend thread. The format string, file and
+ * function names are string literals, so only their pointers are stored together with a compact
+ * encoding of the arguments.
+ */
+struct BinaryEntry {
+    static constexpr size_t MaxArgsSize = 192;
+
+    std::chrono::microseconds timestamp;
+    const char* filename = nullptr;
+    const char* function = nullptr;
+    const char* format = nullptr;
+    u32 line_num = 0;
+    Class log_class{};
+    Level log_level{};
+    u16 args_size = 0;
+    std::array<u8, MaxArgsSize> args;
+};
+
+/// Arguments whose formatted output can be reproduced from their raw value. Everything else,
+/// including types with custom formatters, is formatted on the calling thread.
+template <typename T, typename U = std::decay_t<T>>
+constexpr bool IsDeferrableArg =
+    std::is_same_v<U, bool> || std::is_same_v<U, char> || std::is_same_v<U, float> ||
+    std::is_same_v<U, double> || std::is_same_v<U, char*> || std::is_same_v<U, const char*> ||
+    std::is_same_v<U, void*> || std::is_same_v<U, const void*> ||
+    std::is_same_v<U, std::string> || std::is_same_v<U, std::string_view> ||
+    (std::is_integral_v<U> && sizeof(U) <= sizeof(u64) && !std::is_same_v<U, wchar_t> &&
+     !std::is_same_v<U, char8_t> && !std::is_same_v<U, char16_t> &&
+     !std::is_same_v<U, char32_t>);
+
+namespace detail {
+
+class ArgWriter {
+public:
+    explicit ArgWriter(BinaryEntry& entry_) : entry{entry_} {}
+
+    template <typename T>
+    bool Write(const T& arg) {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>) {
+            return Put(ArgType::Bool, u8(arg));
+        } else if constexpr (std::is_same_v<U, char>) {
+            return Put(ArgType::Char, arg);
+        } else if constexpr (std::is_same_v<U, float>) {
+            return Put(ArgType::Float, arg);
+        } else if constexpr (std::is_same_v<U, double>) {
+            return Put(ArgType::Double, arg);
+        } else if constexpr (std::is_pointer_v<U> && std::is_void_v<std::remove_pointer_t<U>>) {
+            return Put(ArgType::Pointer, reinterpret_cast<u64>(arg));
+        } else if constexpr (std::is_array_v<T>) {
+            return PutString(std::string_view{arg});
+        } else if constexpr (std::is_pointer_v<U>) {
+            return PutString(arg ? std::string_view{arg} : std::string_view{"(null)"});
+        } else if constexpr (std::is_same_v<U, std::string> ||
+                             std::is_same_v<U, std::string_view>) {
+            return PutString(arg);
+        } else if constexpr (std::is_signed_v<U>) {
+            return Put(ArgType::Int, s64(arg));
+        } else {
+            return Put(ArgType::UInt, u64(arg));
+        }
+    }
+
+private:
+    bool Reserve(size_t size) {
+        return entry.args_size + size <= BinaryEntry::MaxArgsSize;
+    }
+
+    void Append(const void* data, size_t size) {
+        std::memcpy(entry.args.data() + entry.args_size, data, size);
+        entry.args_size += static_cast<u16>(size);
+    }
+
+    template <typename T>
+    bool Put(ArgType type, const T& value) {
+        if (!Reserve(sizeof(type) + sizeof(value))) {
+            return false;
+        }
+        Append(&type, sizeof(type));
+        Append(&value, sizeof(value));
+        return true;
+    }
+
+    bool PutString(std::string_view str) {
+        const u16 length = static_cast<u16>(str.size());
+        if (str.size() != length || !Reserve(sizeof(ArgType) + sizeof(length) + length)) {
+            return false;
+        }
+        const ArgType type = ArgType::String;
+        Append(&type, sizeof(type));
+        Append(&length, sizeof(length));
+        Append(str.data(), length);
+        return true;
+    }
+
+    BinaryEntry& entry;
+};
+
+} // namespace detail
+
+/// Encodes the message arguments into the entry, returns false if they do not fit.
+template <typename... Args>
+bool EncodeArgs(BinaryEntry& entry, const Args&... args) {
+    detail::ArgWriter writer{entry};
+    return (writer.Write(args) && ...);
+}
+
+} // namespace Common::Log
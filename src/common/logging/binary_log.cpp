@@ -0,0 +1,278 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <span>
+#include <fmt/args.h>
+#include <fmt/format.h>
+
+#include "common/io_file.h"
+#include "common/logging/binary_log.h"
+#include "common/logging/log_entry.h"
+#include "common/logging/text_formatter.h"
+#include "common/mapped_file.h"
+
+namespace Common::Log {
+
+constexpr u32 BinaryLogMagic = 0x474F4C53; // "SLOG"
+constexpr u32 BinaryLogVersion = 1;
+
+enum class RecordType : u8 {
+    Site,    ///< Defines the file, line, function and format string of a call site.
+    Message, ///< Deferred message referencing a site with its encoded arguments.
+    Text,    ///< Message that was formatted by the caller.
+};
+
+namespace {
+
+class Reader {
+public:
+    explicit Reader(std::span<const u8> data_) : data{data_} {}
+
+    [[nodiscard]] bool AtEnd() const {
+        return data.empty();
+    }
+
+    template <typename T>
+    bool Read(T& value) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        if (data.size() < sizeof(T)) {
+            return false;
+        }
+        std::memcpy(&value, data.data(), sizeof(T));
+        data = data.subspan(sizeof(T));
+        return true;
+    }
+
+    bool ReadBytes(std::span<const u8>& bytes, size_t size) {
+        if (data.size() < size) {
+            return false;
+        }
+        bytes = data.first(size);
+        data = data.subspan(size);
+        return true;
+    }
+
+    bool ReadString(std::string& str) {
+        u32 length{};
+        std::span<const u8> bytes;
+        if (!Read(length) || !ReadBytes(bytes, length)) {
+            return false;
+        }
+        str.assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+        return true;
+    }
+
+private:
+    std::span<const u8> data;
+};
+
+std::string FormatArgs(const char* format, std::span<const u8> args) {
+    fmt::dynamic_format_arg_store<fmt::format_context> store;
+    Reader reader{args};
+    while (!reader.AtEnd()) {
+        ArgType type{};
+        reader.Read(type);
+        bool valid = false;
+        switch (type) {
+        case ArgType::Bool: {
+            u8 value{};
+            valid = reader.Read(value);
+            store.push_back(value != 0);
+            break;
+        }
+        case ArgType::Char: {
+            char value{};
+            valid = reader.Read(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgType::Int: {
+            s64 value{};
+            valid = reader.Read(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgType::UInt: {
+            u64 value{};
+            valid = reader.Read(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgType::Float: {
+            float value{};
+            valid = reader.Read(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgType::Double: {
+            double value{};
+            valid = reader.Read(value);
+            store.push_back(value);
+            break;
+        }
+        case ArgType::Pointer: {
+            u64 value{};
+            valid = reader.Read(value);
+            store.push_back(reinterpret_cast<const void*>(value));
+            break;
+        }
+        case ArgType::String: {
+            u16 length{};
+            std::span<const u8> bytes;
+            valid = reader.Read(length) && reader.ReadBytes(bytes, length);
+            store.push_back(
+                std::string_view{reinterpret_cast<const char*>(bytes.data()), bytes.size()});
+            break;
+        }
+        }
+        if (!valid) {
+            return fmt::format("<corrupted arguments> {}", format);
+        }
+    }
+    try {
+        return fmt::vformat(format, store);
+    } catch (const fmt::format_error& e) {
+        return fmt::format("<{}> {}", e.what(), format);
+    }
+}
+
+} // namespace
+
+std::string FormatBinaryMessage(const BinaryEntry& entry) {
+    return FormatArgs(entry.format, std::span{entry.args.data(), entry.args_size});
+}
+
+template <typename T>
+void BinaryLogWriter::Put(const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    const auto* bytes = reinterpret_cast<const u8*>(&value);
+    buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+}
+
+void BinaryLogWriter::PutString(std::string_view str) {
+    Put(static_cast<u32>(str.size()));
+    buffer.insert(buffer.end(), str.begin(), str.end());
+}
+
+size_t BinaryLogWriter::Commit(const FS::IOFile& file) {
+    const size_t written = file.WriteSpan(std::span<const u8>{buffer});
+    buffer.clear();
+    return written;
+}
+
+size_t BinaryLogWriter::WriteHeader(const FS::IOFile& file) {
+    Put(BinaryLogMagic);
+    Put(BinaryLogVersion);
+    return Commit(file);
+}
+
+size_t BinaryLogWriter::Write(const FS::IOFile& file, const Entry& entry) {
+    Put(RecordType::Text);
+    Put(entry.log_class);
+    Put(entry.log_level);
+    Put(static_cast<u64>(entry.timestamp.count()));
+    Put(entry.line_num);
+    PutString(entry.filename ? entry.filename : "");
+    PutString(entry.function);
+    PutString(entry.message);
+    return Commit(file);
+}
+
+size_t BinaryLogWriter::Write(const FS::IOFile& file, const BinaryEntry& entry) {
+    const auto [it, is_new] = sites.try_emplace(
+        std::make_tuple(entry.format, entry.filename, entry.line_num), u32(sites.size()));
+    const u32 site_id = it->second;
+    if (is_new) {
+        Put(RecordType::Site);
+        Put(site_id);
+        Put(entry.line_num);
+        PutString(entry.filename);
+        PutString(entry.function);
+        PutString(entry.format);
+    }
+    Put(RecordType::Message);
+    Put(site_id);
+    Put(entry.log_class);
+    Put(entry.log_level);
+    Put(static_cast<u64>(entry.timestamp.count()));
+    Put(entry.args_size);
+    buffer.insert(buffer.end(), entry.args.begin(), entry.args.begin() + entry.args_size);
+    return Commit(file);
+}
+
+bool DecodeBinaryLog(const std::filesystem::path& input, const std::filesystem::path& output) {
+    const FS::MappedFile file{input};
+    if (!file.IsOpen()) {
+        return false;
+    }
+    Reader reader{file.Data()};
+    u32 magic{};
+    u32 version{};
+    if (!reader.Read(magic) || !reader.Read(version) || magic != BinaryLogMagic ||
+        version != BinaryLogVersion) {
+        return false;
+    }
+
+    const FS::IOFile out{output, FS::FileAccessMode::Write, FS::FileType::TextFile};
+    if (!out.IsOpen()) {
+        return false;
+    }
+
+    struct Site {
+        u32 line_num;
+        std::string filename;
+        std::string function;
+        std::string format;
+    };
+    std::vector<Site> sites;
+
+    // A log that was cut short by a crash simply ends in the middle of a record.
+    while (!reader.AtEnd()) {
+        RecordType type{};
+        Entry entry{};
+        u64 timestamp{};
+        std::string filename;
+        reader.Read(type);
+        if (type == RecordType::Site) {
+            u32 site_id{};
+            Site site{};
+            if (!reader.Read(site_id) || !reader.Read(site.line_num) ||
+                !reader.ReadString(site.filename) || !reader.ReadString(site.function) ||
+                !reader.ReadString(site.format) || site_id != sites.size()) {
+                break;
+            }
+            sites.push_back(std::move(site));
+            continue;
+        } else if (type == RecordType::Message) {
+            u32 site_id{};
+            u16 args_size{};
+            std::span<const u8> args;
+            if (!reader.Read(site_id) || !reader.Read(entry.log_class) ||
+                !reader.Read(entry.log_level) || !reader.Read(timestamp) ||
+                !reader.Read(args_size) || !reader.ReadBytes(args, args_size) ||
+                site_id >= sites.size()) {
+                break;
+            }
+            const Site& site = sites[site_id];
+            entry.filename = site.filename.c_str();
+            entry.line_num = site.line_num;
+            entry.function = site.function;
+            entry.message = FormatArgs(site.format.c_str(), args);
+        } else if (type == RecordType::Text) {
+            if (!reader.Read(entry.log_class) || !reader.Read(entry.log_level) ||
+                !reader.Read(timestamp) || !reader.Read(entry.line_num) ||
+                !reader.ReadString(filename) || !reader.ReadString(entry.function) ||
+                !reader.ReadString(entry.message)) {
+                break;
+            }
+            entry.filename = filename.c_str();
+        } else {
+            break;
+        }
+        entry.timestamp = std::chrono::microseconds{timestamp};
+        out.WriteString(FormatLogMessage(entry).append(1, '\n'));
+    }
+    return true;
+}
+
+} // namespace Common::Log
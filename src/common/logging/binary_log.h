@@ -0,0 +1,52 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#include "common/logging/binary_entry.h"
+
+namespace Common::FS {
+class IOFile;
+}
+
+namespace Common::Log {
+
+struct Entry;
+
+/// Formats the message of a deferred entry.
+std::string FormatBinaryMessage(const BinaryEntry& entry);
+
+/**
+ * Serializes log entries into the binary log format. Call sites are written once to a site table
+ * on first use, after which each message only stores the site index, the timestamp and the
+ * encoded arguments. Messages that were formatted by the caller are stored as text.
+ */
+class BinaryLogWriter {
+public:
+    /// Writes the file header, must be called once on an empty file.
+    size_t WriteHeader(const FS::IOFile& file);
+
+    size_t Write(const FS::IOFile& file, const Entry& entry);
+    size_t Write(const FS::IOFile& file, const BinaryEntry& entry);
+
+private:
+    template <typename T>
+    void Put(const T& value);
+    void PutString(std::string_view str);
+    size_t Commit(const FS::IOFile& file);
+
+    std::map<std::tuple<const char*, const char*, u32>, u32> sites;
+    std::vector<u8> buffer;
+};
+
+/// Converts a binary log into the text format of the regular log file.
+bool DecodeBinaryLog(const std::filesystem::path& input, const std::filesystem::path& output);
+
+} // namespace Common::Log
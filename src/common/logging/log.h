@@ -7,6 +7,7 @@
 #include <array>
 #include <string_view>
 
+#include "common/logging/binary_entry.h"
 #include "common/logging/formatter.h"
 #include "common/logging/types.h"
 
@@ -25,9 +26,31 @@ void FmtLogMessageImpl(Class log_class, Level log_level, const char* filename,
                        unsigned int line_num, const char* function, const char* format,
                        const fmt::format_args& args);
 
+/// Returns true when the binary log mode is active and messages may be formatted lazily.
+bool IsBinaryLogging();
+
+/// Queues a deferred message for formatting on the backend thread.
+void PushBinaryEntry(const BinaryEntry& entry);
+
 template <typename... Args>
 void FmtLogMessage(Class log_class, Level log_level, const char* filename, unsigned int line_num,
                    const char* function, const char* format, const Args&... args) {
+    if constexpr ((IsDeferrableArg<Args> && ...)) {
+        if (IsBinaryLogging()) {
+            BinaryEntry entry{
+                .filename = filename,
+                .function = function,
+                .format = format,
+                .line_num = line_num,
+                .log_class = log_class,
+                .log_level = log_level,
+            };
+            if (EncodeArgs(entry, args...)) {
+                PushBinaryEntry(entry);
+                return;
+            }
+        }
+    }
     FmtLogMessageImpl(log_class, log_level, filename, line_num, function, format,
                       fmt::make_format_args(args...));
 }
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <algorithm>
+#include <filesystem>
+#include <span>
+
+#include "common/types.h"
+
+namespace Common::FS {
+
+/**
+ * Read-only memory mapping of a whole file. Reads through the mapping avoid a copy through
+ * stdio buffers and can be issued concurrently from any number of threads.
+ */
+class MappedFile {
+public:
+    MappedFile();
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    [[nodiscard]] bool IsOpen() const noexcept {
+        return data != nullptr;
+    }
+
+    [[nodiscard]] u64 GetSize() const noexcept {
+        return size;
+    }
+
+    [[nodiscard]] std::span<const u8> Data() const noexcept {
+        return {data, size};
+    }
+
+    /// Returns the requested range clamped to the end of the file.
+    [[nodiscard]] std::span<const u8> Subspan(u64 offset, u64 length) const noexcept {
+        if (offset >= size) {
+            return {};
+        }
+        return {data + offset, std::min(length, size - offset)};
+    }
+
+private:
+    const u8* data{};
+    u64 size{};
+#ifdef _WIN32
+    void* file_handle{};
+    void* mapping_handle{};
+#endif
+};
+
+} // namespace Common::FS
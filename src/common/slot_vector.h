@@ -78,6 +78,22 @@ public:
         return values_capacity - free_list.size();
     }
 
+    /// Invokes func with the id and value of every occupied slot. The vector must not be modified
+    /// from within func.
+    template <typename Func>
+    void ForEach(Func&& func) {
+        std::size_t index = 0;
+        for (u64 bits : stored_bitset) {
+            for (std::size_t bit = 0; bits; ++bit, bits >>= 1) {
+                if ((bits & 1) != 0) {
+                    const u32 slot = static_cast<u32>(index + bit);
+                    func(SlotId{slot}, values[slot].object);
+                }
+            }
+            index += 64;
+        }
+    }
+
 private:
     struct NonTrivialDummy {
         NonTrivialDummy() noexcept {}
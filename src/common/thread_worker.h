@@ -0,0 +1,101 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <vector>
+
+#include "common/polyfill_thread.h"
+#include "common/thread.h"
+#include "common/types.h"
+#include "common/unique_function.h"
+
+namespace Common {
+
+/**
+ * Fixed size pool of host threads executing queued work items in submission order.
+ * Work that is still queued when the worker is destroyed runs before its threads exit, so
+ * nothing waiting on a work item is left hanging.
+ */
+class ThreadWorker {
+public:
+    using Task = UniqueFunction<void>;
+
+    explicit ThreadWorker(size_t num_workers, std::string name_) : name{std::move(name_)} {
+        threads.reserve(num_workers);
+        for (size_t i = 0; i < num_workers; ++i) {
+            threads.emplace_back([this](std::stop_token stop_token) { WorkerLoop(stop_token); });
+        }
+    }
+
+    ~ThreadWorker() {
+        for (auto& thread : threads) {
+            thread.request_stop();
+        }
+        work_cv.notify_all();
+        threads.clear();
+    }
+
+    ThreadWorker(const ThreadWorker&) = delete;
+    ThreadWorker& operator=(const ThreadWorker&) = delete;
+
+    template <typename Func>
+    void QueueWork(Func&& work) {
+        {
+            std::scoped_lock lock{queue_mutex};
+            requests.emplace(std::forward<Func>(work));
+            ++work_scheduled;
+        }
+        work_cv.notify_one();
+    }
+
+    /// Blocks the calling thread until every queued work item has been executed.
+    void WaitForRequests() {
+        std::unique_lock lock{queue_mutex};
+        done_cv.wait(lock, [this] { return work_done == work_scheduled; });
+    }
+
+    [[nodiscard]] size_t NumWorkers() const noexcept {
+        return threads.size();
+    }
+
+private:
+    void WorkerLoop(std::stop_token stop_token) {
+        SetCurrentThreadName(name.c_str());
+        while (true) {
+            Task task;
+            {
+                std::unique_lock lock{queue_mutex};
+                CondvarWait(work_cv, lock, stop_token, [this] { return !requests.empty(); });
+                // Once stop is requested the wait returns immediately and the queue is drained.
+                if (requests.empty()) {
+                    return;
+                }
+                task = std::move(requests.front());
+                requests.pop();
+            }
+            task();
+            {
+                std::scoped_lock lock{queue_mutex};
+                ++work_done;
+            }
+            done_cv.notify_all();
+        }
+    }
+
+private:
+    std::string name;
+    std::mutex queue_mutex;
+    std::condition_variable_any work_cv;
+    std::condition_variable done_cv;
+    std::queue<Task> requests;
+    u64 work_scheduled{};
+    u64 work_done{};
+    std::vector<std::jthread> threads;
+};
+
+} // namespace Common
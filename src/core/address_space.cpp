@@ -6,6 +6,7 @@
 #include "common/alignment.h"
 #include "common/arch.h"
 #include "common/assert.h"
+#include "common/config.h"
 #include "common/error.h"
 #include "core/address_space.h"
 #include "core/libraries/kernel/memory.h"
@@ -16,6 +17,7 @@
 #include <windows.h>
 #else
 #include <fcntl.h>
+#include <fstream>
 #include <sys/mman.h>
 #endif
 
@@ -369,6 +371,18 @@ enum PosixPageProtection {
     }
 }
 
+#ifndef __APPLE__
+/// Checks whether the kernel lets shared memory be backed by transparent huge pages on request.
+[[nodiscard]] static bool ShmemHugePagesAvailable() {
+    std::ifstream file{"/sys/kernel/mm/transparent_hugepage/shmem_enabled"};
+    std::string mode;
+    if (!std::getline(file, mode)) {
+        return false;
+    }
+    return mode.find("[never]") == std::string::npos && mode.find("[deny]") == std::string::npos;
+}
+#endif
+
 struct AddressSpace::Impl {
     Impl() {
         // Allocate virtual address placeholder for our address space.
@@ -467,6 +481,23 @@ struct AddressSpace::Impl {
             LOG_CRITICAL(Kernel_Vmm, "mmap failed: {}", strerror(errno));
             throw std::bad_alloc{};
         }
+
+#ifndef __APPLE__
+        // Back direct memory with 2MB pages where the kernel allows it. Explicit hugetlb pages
+        // cannot be protected at 4KB granularity, which write tracking relies on, so transparent
+        // huge pages are used instead. The kernel splits the page table entries of a huge page
+        // that is partially protected and keeps the rest of the mapping huge.
+        if (Config::isHugePagesEnabled()) {
+            use_huge_pages = ShmemHugePagesAvailable() &&
+                             madvise(backing_base, BackingSize, MADV_HUGEPAGE) == 0;
+            if (use_huge_pages) {
+                LOG_INFO(Kernel_Vmm, "Direct memory is backed by transparent huge pages");
+            } else {
+                LOG_WARNING(Kernel_Vmm, "Huge pages were requested but transparent huge pages "
+                                        "are disabled for shared memory (shmem_enabled)");
+            }
+        }
+#endif
     }
 
     void* Map(VAddr virtual_addr, PAddr phys_addr, size_t size, PosixPageProtection prot,
@@ -478,6 +509,12 @@ struct AddressSpace::Impl {
         void* ret = mmap(reinterpret_cast<void*>(virtual_addr), size, prot, MAP_FIXED | flag,
                          handle, host_offset);
         ASSERT_MSG(ret != MAP_FAILED, "mmap failed: {}", strerror(errno));
+#ifndef __APPLE__
+        // Advice is tracked per mapping, so every guest view of direct memory needs its own.
+        if (use_huge_pages && handle == backing_fd) {
+            madvise(ret, size, MADV_HUGEPAGE);
+        }
+#endif
         return ret;
     }
 
@@ -520,6 +557,7 @@ struct AddressSpace::Impl {
     }
 
     int backing_fd;
+    bool use_huge_pages{};
     u8* backing_base{};
     u8* system_managed_base{};
     size_t system_managed_size{};
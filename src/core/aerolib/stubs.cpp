@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <mutex>
 #include "common/logging/log.h"
 #include "core/aerolib/aerolib.h"
 #include "core/aerolib/stubs.h"
@@ -48,6 +49,7 @@ static u64 CommonStub() {
 }
 
 static u32 UsedStubEntries;
+static std::mutex stub_mutex; ///< Modules are relocated in parallel at boot.
 
 #define XREP_1(x) &CommonStub<x>,
 
@@ -67,6 +69,7 @@ static u32 UsedStubEntries;
 static u64 (*stub_handlers[MAX_STUBS])() = {STUBS_LIST};
 
 u64 GetStub(const char* nid) {
+    std::scoped_lock lk{stub_mutex};
     if (UsedStubEntries >= MAX_STUBS) {
         return (u64)&UnknownStub;
     }
@@ -19,11 +19,36 @@ constexpr float BAR_HEIGHT_MULT = 1.25f;
 constexpr float FRAME_GRAPH_PADDING_Y = 3.0f;
 constexpr static float FRAME_GRAPH_HEIGHT = 50.0f;
 
+void FrameGraph::DrawGpuStats() {
+    const auto& stats = VideoCore::GpuStats::Instance();
+    const u32 frame_num = DebugState.GetFrameNum();
+    if (frame_num != last_stats_frame) {
+        // Average the counters over the flips that happened since the last sample.
+        const u32 num_frames = frame_num - last_stats_frame;
+        for (size_t i = 0; i < NumStats; ++i) {
+            const u64 value = stats.Get(static_cast<VideoCore::Stat>(i));
+            frame_stats[i] = (value - last_stats[i]) / num_frames;
+            last_stats[i] = value;
+        }
+        last_stats_frame = frame_num;
+    }
+
+    SeparatorText("GPU stats");
+    for (size_t i = 0; i < NumStats; ++i) {
+        const auto& info = VideoCore::StatInfos[i];
+        if (info.is_gauge) {
+            Text("%s: %llu", info.name, static_cast<unsigned long long>(last_stats[i]));
+        } else {
+            Text("%s: %llu/frame", info.name, static_cast<unsigned long long>(frame_stats[i]));
+        }
+    }
+}
+
 void FrameGraph::Draw() {
     if (!is_open) {
         return;
     }
-    SetNextWindowSize({340.0, 185.0f}, ImGuiCond_FirstUseEver);
+    SetNextWindowSize({340.0, 260.0f}, ImGuiCond_FirstUseEver);
     if (Begin("Video debug info", &is_open)) {
         const auto& ctx = *GImGui;
         const auto& io = ctx.IO;
@@ -92,6 +117,8 @@ void FrameGraph::Draw() {
             }
         }
         draw_list.PopClipRect();
+
+        DrawGpuStats();
     }
     End();
 }
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "common/types.h"
+#include "video_core/gpu_stats.h"
 
 namespace Core::Devtools::Widget {
 
@@ -14,7 +15,14 @@ class FrameGraph {
         float delta;
     };
 
+    static constexpr size_t NumStats = static_cast<size_t>(VideoCore::Stat::NumStats);
+
     std::array<FrameInfo, FRAME_BUFFER_SIZE> frame_list{};
+    std::array<u64, NumStats> last_stats{};
+    std::array<u64, NumStats> frame_stats{};
+    u32 last_stats_frame{};
+
+    void DrawGpuStats();
 
 public:
     bool is_open = true;
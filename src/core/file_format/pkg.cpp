@@ -1,12 +1,31 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <latch>
+#include <mutex>
+#include <thread>
 #include <zlib.h>
+#include "common/alignment.h"
+#include "common/div_ceil.h"
 #include "common/io_file.h"
 #include "common/logging/formatter.h"
+#include "common/logging/log.h"
+#include "common/mapped_file.h"
+#include "common/thread_worker.h"
 #include "core/file_format/pkg.h"
 #include "core/file_format/pkg_type.h"
 
+constexpr u64 PfscBlockSize = 0x10000;
+constexpr u64 XtsSectorSize = 0x1000;
+
+// Blocks decoded by one worker task, and blocks gathered into a single output write.
+constexpr u32 BlocksPerTask = 16;
+constexpr u32 BlocksPerWrite = 128;
+
 static void DecompressPFSC(std::span<char> compressed_data, std::span<char> decompressed_data) {
     z_stream decompressStream;
     decompressStream.zalloc = Z_NULL;
@@ -40,10 +59,31 @@ u32 GetPFSCOffset(std::span<const u8> pfs_image) {
     return -1;
 }
 
+struct PKG::ExtractState {
+    Common::FS::MappedFile pkg_file;
+    std::unique_ptr<Common::ThreadWorker> worker;
+    std::mutex journal_mutex;
+    Common::FS::IOFile journal;
+    std::filesystem::path journal_path;
+    std::unordered_map<u32, u32> resume_blocks;
+    std::atomic<u64> bytes_written{};
+    std::atomic<u32> files_done{};
+    std::atomic<u32> files_failed{};
+    std::chrono::steady_clock::time_point start;
+};
+
 PKG::PKG() = default;
 
 PKG::~PKG() = default;
 
+PKG::PKG(PKG&&) noexcept = default;
+
+PKG& PKG::operator=(PKG&&) noexcept = default;
+
+u32 PKG::GetNumberOfFailedFiles() const {
+    return extract_state ? extract_state->files_failed.load() : 0;
+}
+
 bool PKG::Open(const std::filesystem::path& filepath, std::string& failreason) {
     Common::FS::IOFile file(filepath, Common::FS::FileAccessMode::Read);
     if (!file.IsOpen()) {
@@ -106,6 +146,10 @@ bool PKG::Extract(const std::filesystem::path& filepath, const std::filesystem::
                   std::string& failreason) {
     extract_path = extract;
     pkgpath = filepath;
+    fsTable.clear();
+    iNodeBuf.clear();
+    extractPaths.clear();
+    sectorMap.clear();
     Common::FS::IOFile file(filepath, Common::FS::FileAccessMode::Read);
     if (!file.IsOpen()) {
         return false;
@@ -405,69 +449,226 @@ bool PKG::Extract(const std::filesystem::path& filepath, const std::filesystem::
             }
         }
     }
+
+    // File contents are read through a mapping of the whole package by the worker pool.
+    extract_state = std::make_unique<ExtractState>();
+    auto& state = *extract_state;
+    if (!state.pkg_file.Open(pkgpath)) {
+        failreason = "Failed to map PKG file";
+        return false;
+    }
+    const u32 num_threads = std::max(std::thread::hardware_concurrency(), 1U);
+    state.worker = std::make_unique<Common::ThreadWorker>(num_threads, "shadPS4:PkgExtract");
+    OpenJournal();
+    state.start = std::chrono::steady_clock::now();
+    if (fsTable.empty()) {
+        FinishExtraction();
+    }
     return true;
 }
 
 void PKG::ExtractFiles(const int index) {
-    int inode_number = fsTable[index].inode;
-    int inode_type = fsTable[index].type;
-    std::string inode_name = fsTable[index].name;
-
-    if (inode_type == PFS_FILE) {
-        int sector_loc = iNodeBuf[inode_number].loc;
-        int nblocks = iNodeBuf[inode_number].Blocks;
-        int bsize = iNodeBuf[inode_number].Size;
-
-        Common::FS::IOFile inflated;
-        inflated.Open(extractPaths[inode_number], Common::FS::FileAccessMode::Write);
-
-        Common::FS::IOFile pkgFile; // Open the file for each iteration to avoid conflict.
-        pkgFile.Open(pkgpath, Common::FS::FileAccessMode::Read);
-
-        int size_decompressed = 0;
-        std::vector<char> compressedData;
-        std::vector<char> decompressedData(0x10000);
-
-        u64 pfsc_buf_size = 0x11000; // extra 0x1000
-        std::vector<u8> pfsc(pfsc_buf_size);
-        std::vector<u8> pfs_decrypted(pfsc_buf_size);
-
-        for (int j = 0; j < nblocks; j++) {
-            u64 sectorOffset =
-                sectorMap[sector_loc + j]; // offset into PFSC_image and not pfs_image.
-            u64 sectorSize = sectorMap[sector_loc + j + 1] -
-                             sectorOffset; // indicates if data is compressed or not.
-            u64 fileOffset = (pkgheader.pfs_image_offset + pfsc_offset + sectorOffset);
-            u64 currentSector1 =
-                (pfsc_offset + sectorOffset) / 0x1000; // block size is 0x1000 for xts decryption.
-
-            int sectorOffsetMask = (sectorOffset + pfsc_offset) & 0xFFFFF000;
-            int previousData = (sectorOffset + pfsc_offset) - sectorOffsetMask;
-
-            pkgFile.Seek(fileOffset - previousData);
-            pkgFile.Read(pfsc);
-
-            PKG::crypto.decryptPFS(dataKey, tweakKey, pfsc, pfs_decrypted, currentSector1);
-
-            compressedData.resize(sectorSize);
-            std::memcpy(compressedData.data(), pfs_decrypted.data() + previousData, sectorSize);
-
-            if (sectorSize == 0x10000) // Uncompressed data
-                std::memcpy(decompressedData.data(), compressedData.data(), 0x10000);
-            else if (sectorSize < 0x10000) // Compressed data
-                DecompressPFSC(compressedData, decompressedData);
-
-            size_decompressed += 0x10000;
-
-            if (j < nblocks - 1) {
-                inflated.WriteRaw<u8>(decompressedData.data(), decompressedData.size());
-            } else {
-                // This is to remove the zeros at the end of the file.
-                const u32 write_size = decompressedData.size() - (size_decompressed - bsize);
-                inflated.WriteRaw<u8>(decompressedData.data(), write_size);
+    auto& state = *extract_state;
+    const auto& table = fsTable[index];
+    if (table.type == PFS_FILE && !ExtractInode(table.inode)) {
+        ++state.files_failed;
+    }
+    // The last entry to complete finalizes the installation.
+    if (state.files_done.fetch_add(1) + 1 == fsTable.size()) {
+        FinishExtraction();
+    }
+}
+
+bool PKG::ExtractInode(u32 inode_number) {
+    auto& state = *extract_state;
+    const auto path_it = extractPaths.find(inode_number);
+    if (path_it == extractPaths.end()) {
+        LOG_ERROR(Loader, "No path for PFS inode {}", inode_number);
+        return false;
+    }
+    const auto& path = path_it->second;
+    const Inode& inode = iNodeBuf[inode_number];
+    const u32 sector_loc = inode.loc;
+    const u32 nblocks = inode.Blocks;
+    const u64 file_size = inode.Size;
+
+    u32 first_block = 0;
+    if (const auto it = state.resume_blocks.find(inode_number);
+        it != state.resume_blocks.end()) {
+        first_block = std::min(it->second, nblocks);
+    }
+    if (first_block == nblocks && std::filesystem::exists(path)) {
+        return true;
+    }
+
+    Common::FS::IOFile out;
+    if (first_block != 0) {
+        // Every block before the recorded one is complete, continue right after it.
+        const u64 resume_offset = first_block * PfscBlockSize;
+        out.Open(path, Common::FS::FileAccessMode::ReadWrite);
+        if (out.IsOpen() && out.GetSize() >= resume_offset && out.SetSize(resume_offset) &&
+            out.Seek(resume_offset)) {
+            LOG_INFO(Loader, "Resuming {} at block {}/{}", fmt::UTF(path.u8string()), first_block,
+                     nblocks);
+        } else {
+            first_block = 0;
+            out.Close();
+        }
+    }
+    if (first_block == 0) {
+        out.Open(path, Common::FS::FileAccessMode::Write);
+    }
+    if (!out.IsOpen()) {
+        LOG_ERROR(Loader, "Failed to open {}", fmt::UTF(path.u8string()));
+        return false;
+    }
+
+    std::vector<u8> buffer(std::min(nblocks - first_block, BlocksPerWrite) * PfscBlockSize);
+    for (u32 block = first_block; block < nblocks; block += BlocksPerWrite) {
+        const u32 count = std::min(nblocks - block, BlocksPerWrite);
+        DecodeBlocksParallel(sector_loc + block, count, buffer.data());
+
+        // The last block is zero padded, only write up to the size of the file.
+        const u64 offset = block * PfscBlockSize;
+        const u64 write_size =
+            offset < file_size ? std::min(count * PfscBlockSize, file_size - offset) : 0;
+        if (out.WriteRaw<u8>(buffer.data(), write_size) != write_size) {
+            LOG_ERROR(Loader, "Failed to write {}", fmt::UTF(path.u8string()));
+            return false;
+        }
+        state.bytes_written += write_size;
+        if (block + count < nblocks) {
+            // Progress is only recorded once the blocks before it are known to be on disk.
+            if (!out.Flush()) {
+                LOG_ERROR(Loader, "Failed to write {}", fmt::UTF(path.u8string()));
+                return false;
             }
+            RecordProgress(inode_number, block + count);
         }
-        pkgFile.Close();
-        inflated.Close();
     }
+    if (!out.Flush()) {
+        LOG_ERROR(Loader, "Failed to write {}", fmt::UTF(path.u8string()));
+        return false;
+    }
+    out.Close();
+    RecordProgress(inode_number, nblocks);
+    return true;
+}
+
+void PKG::DecodeBlocksParallel(u32 first_block, u32 num_blocks, u8* out) {
+    auto* const worker = extract_state ? extract_state->worker.get() : nullptr;
+    if (!worker || num_blocks <= BlocksPerTask) {
+        DecodeBlocks(first_block, num_blocks, out);
+        return;
+    }
+    // Tasks from concurrent ExtractFiles calls share the pool, so wait only for our own.
+    const u32 num_tasks = Common::DivCeil(num_blocks, BlocksPerTask);
+    std::latch done{num_tasks};
+    for (u32 task = 0; task < num_tasks; task++) {
+        const u32 begin = task * BlocksPerTask;
+        const u32 count = std::min(num_blocks - begin, BlocksPerTask);
+        worker->QueueWork([this, &done, block = first_block + begin, count,
+                           dst = out + begin * PfscBlockSize] {
+            DecodeBlocks(block, count, dst);
+            done.count_down();
+        });
+    }
+    done.wait();
+}
+
+void PKG::DecodeBlocks(u32 first_block, u32 num_blocks, u8* out) {
+    std::vector<u8> decrypted;
+    for (u32 i = 0; i < num_blocks; i++) {
+        u8* block = out + i * PfscBlockSize;
+        const u64 sectorOffset = sectorMap[first_block + i]; // offset into PFSC_image.
+        const u64 sectorSize = sectorMap[first_block + i + 1] - sectorOffset;
+
+        // XTS decryption works on 0x1000 byte sectors of the pfs_image.
+        const u64 imageOffset = pfsc_offset + sectorOffset;
+        const u64 alignedOffset = Common::AlignDown(imageOffset, XtsSectorSize);
+        const u64 previousData = imageOffset - alignedOffset;
+        const u64 readSize = Common::AlignUp(previousData + sectorSize, XtsSectorSize);
+        const auto encrypted =
+            extract_state->pkg_file.Subspan(pkgheader.pfs_image_offset + alignedOffset, readSize);
+        if (encrypted.size() != readSize || sectorSize > PfscBlockSize) {
+            LOG_ERROR(Loader, "PFSC block {} is out of bounds", first_block + i);
+            std::memset(block, 0, PfscBlockSize);
+            continue;
+        }
+
+        decrypted.resize(readSize);
+        PKG::crypto.decryptPFS(dataKey, tweakKey, encrypted, decrypted,
+                               alignedOffset / XtsSectorSize);
+
+        char* data = reinterpret_cast<char*>(decrypted.data() + previousData);
+        if (sectorSize == PfscBlockSize) { // Uncompressed data
+            std::memcpy(block, data, PfscBlockSize);
+        } else { // Compressed data
+            DecompressPFSC({data, sectorSize}, {reinterpret_cast<char*>(block), PfscBlockSize});
+        }
+    }
+}
+
+void PKG::OpenJournal() {
+    // The journal records how far each file got, so an interrupted install of the same package
+    // can skip the work that was already done.
+    auto& state = *extract_state;
+    state.journal_path = extract_path / "pkg_extract.journal";
+
+    bool resume = false;
+    if (std::filesystem::exists(state.journal_path)) {
+        Common::FS::IOFile file(state.journal_path, Common::FS::FileAccessMode::Read);
+        std::array<u8, 0x20> digest{};
+        if (file.Read(digest) == digest.size() &&
+            std::memcmp(digest.data(), pkgheader.pkg_digest, digest.size()) == 0) {
+            resume = true;
+            JournalEntry entry{};
+            while (file.ReadObject(entry)) {
+                state.resume_blocks.insert_or_assign(entry.inode, entry.blocks_done);
+            }
+        }
+    }
+
+    if (resume) {
+        LOG_INFO(Loader, "Resuming interrupted extraction, {} files have progress",
+                 state.resume_blocks.size());
+        state.journal.Open(state.journal_path, Common::FS::FileAccessMode::Append);
+    } else {
+        state.journal.Open(state.journal_path, Common::FS::FileAccessMode::Write);
+        state.journal.WriteRaw<u8>(pkgheader.pkg_digest, sizeof(pkgheader.pkg_digest));
+        state.journal.Flush();
+    }
+}
+
+void PKG::RecordProgress(u32 inode, u32 blocks_done) {
+    auto& state = *extract_state;
+    std::scoped_lock lock{state.journal_mutex};
+    if (state.journal.IsOpen()) {
+        state.journal.WriteObject(JournalEntry{inode, blocks_done});
+        state.journal.Flush();
+    }
+}
+
+void PKG::FinishExtraction() {
+    auto& state = *extract_state;
+    {
+        std::scoped_lock lock{state.journal_mutex};
+        state.journal.Close();
+    }
+    state.pkg_file.Close();
+    state.worker.reset();
+
+    // Files that failed keep their recorded progress, installing the package again resumes them.
+    if (const u32 num_failed = state.files_failed; num_failed != 0) {
+        LOG_ERROR(Loader, "Failed to extract {} of {} files, kept {} to resume the installation",
+                  num_failed, fsTable.size(), fmt::UTF(state.journal_path.u8string()));
+        return;
+    }
+    const double seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - state.start).count();
+    const double megabytes = static_cast<double>(state.bytes_written) / (1024.0 * 1024.0);
+    LOG_INFO(Loader, "Extracted {:.1f} MB in {:.2f} s ({:.1f} MB/s)", megabytes, seconds,
+             megabytes / std::max(seconds, 0.001));
+    std::error_code ec;
+    std::filesystem::remove(state.journal_path, ec);
 }
@@ -5,6 +5,7 @@
 
 #include <array>
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -103,6 +104,9 @@ public:
     PKG();
     ~PKG();
 
+    PKG(PKG&&) noexcept;
+    PKG& operator=(PKG&&) noexcept;
+
     bool Open(const std::filesystem::path& filepath, std::string& failreason);
     void ExtractFiles(const int index);
     bool Extract(const std::filesystem::path& filepath, const std::filesystem::path& extract,
@@ -114,6 +118,12 @@ public:
         return fsTable.size();
     }
 
+    /// Returns the number of files of the last extraction that could not be written. When it is
+    /// not zero, pkg_extract.journal stays in the install directory so that installing the same
+    /// package again resumes the extraction. The journal is also kept when the extraction is
+    /// cancelled before every file was extracted.
+    u32 GetNumberOfFailedFiles() const;
+
     u64 GetPkgSize() {
         return pkgSize;
     }
@@ -146,6 +156,20 @@ public:
          {PKGContentFlag::DELTA_PATCH, "DELTA_PATCH"},
          {PKGContentFlag::CUMULATIVE_PATCH, "CUMULATIVE_PATCH"}}};
 
+private:
+    struct JournalEntry {
+        u32 inode;
+        u32 blocks_done;
+    };
+    struct ExtractState;
+
+    void OpenJournal();
+    void RecordProgress(u32 inode, u32 blocks_done);
+    void FinishExtraction();
+    bool ExtractInode(u32 inode_number);
+    void DecodeBlocks(u32 first_block, u32 num_blocks, u8* out);
+    void DecodeBlocksParallel(u32 first_block, u32 num_blocks, u8* out);
+
 private:
     Crypto crypto;
     TRP trp;
@@ -171,4 +195,7 @@ private:
     std::filesystem::path pkgpath;
     std::filesystem::path current_dir;
     std::filesystem::path extract_path;
+
+    // State shared by the concurrent ExtractFiles calls of one installation.
+    std::unique_ptr<ExtractState> extract_state;
 };
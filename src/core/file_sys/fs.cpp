@@ -152,6 +152,7 @@ int HandleTable::CreateHandle() {
 }
 
 void HandleTable::DeleteHandle(int d) {
+    std::unique_lock delete_lock{m_delete_mutex};
     std::scoped_lock lock{m_mutex};
     delete m_files.at(d - RESERVED_HANDLES);
     m_files[d - RESERVED_HANDLES] = nullptr;
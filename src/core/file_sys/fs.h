@@ -5,10 +5,12 @@
 
 #include <atomic>
 #include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <vector>
 #include <tsl/robin_map.h>
 #include "common/io_file.h"
+#include "common/mapped_file.h"
 
 namespace Core::FileSys {
 
@@ -64,6 +66,14 @@ struct File {
     std::vector<DirEntry> dirents;
     u32 dirents_index;
     std::mutex m_mutex;
+
+    /// Mapping of a file opened for reading on a read-only mount. When it is open, reads are
+    /// served from it and the file position is tracked in mapped_pos instead of by f.
+    Common::FS::MappedFile mapped;
+    u64 mapped_pos{};
+    std::atomic<u64> num_reads{};
+    std::atomic<u64> num_mapped_reads{};
+    std::atomic<u64> mapped_bytes{};
 };
 
 class HandleTable {
@@ -76,9 +86,17 @@ public:
     File* GetFile(int d);
     File* GetFile(const std::filesystem::path& host_name);
 
+    /// Keeps files from being deleted while the returned lock is held. Reads served from the
+    /// mapping of a file take it before looking the file up, so that a concurrent close waits
+    /// for them instead of unmapping the data they copy.
+    [[nodiscard]] std::shared_lock<std::shared_mutex> LockFiles() {
+        return std::shared_lock{m_delete_mutex};
+    }
+
 private:
     std::vector<File*> m_files;
     std::mutex m_mutex;
+    std::shared_mutex m_delete_mutex;
 };
 
 } // namespace Core::FileSys
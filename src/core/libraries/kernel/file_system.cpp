@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <cstring>
 #include "common/assert.h"
 #include "common/logging/log.h"
 #include "common/scope_exit.h"
@@ -24,6 +25,16 @@ auto GetDirectoryEntries(const std::filesystem::path& path) {
     return files;
 }
 
+/// Copies guest read data out of the mapping of a read-only file, without a host syscall. The
+/// caller holds HandleTable::LockFiles so that the mapping outlives the copy.
+static size_t ReadMapped(Core::FileSys::File* file, void* buf, size_t nbytes, u64 offset) {
+    const auto data = file->mapped.Subspan(offset, nbytes);
+    std::memcpy(buf, data.data(), data.size());
+    file->num_mapped_reads.fetch_add(1, std::memory_order_relaxed);
+    file->mapped_bytes.fetch_add(data.size(), std::memory_order_relaxed);
+    return data.size();
+}
+
 int PS4_SYSV_ABI sceKernelOpen(const char* path, int flags, u16 mode) {
     LOG_INFO(Kernel_Fs, "path = {} flags = {:#x} mode = {}", path, flags, mode);
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
@@ -75,10 +86,16 @@ int PS4_SYSV_ABI sceKernelOpen(const char* path, int flags, u16 mode) {
         }
     } else {
         file->m_guest_name = path;
-        file->m_host_name = mnt->GetHostPath(file->m_guest_name);
+        bool read_only_mount = false;
+        file->m_host_name = mnt->GetHostPath(file->m_guest_name, &read_only_mount);
         int e = 0;
         if (read) {
             e = file->f.Open(file->m_host_name, Common::FS::FileAccessMode::Read);
+            // Files on read-only mounts cannot change underneath the mapping. Empty files or
+            // files that fail to map keep using the regular path.
+            if (e == 0 && read_only_mount) {
+                file->mapped.Open(file->m_host_name);
+            }
         } else if (write && (create || truncate)) {
             e = file->f.Open(file->m_host_name, Common::FS::FileAccessMode::Write);
         } else if (write && create && append) { // CUSA04729 (appends app0/shaderlist.txt)
@@ -140,6 +157,11 @@ int PS4_SYSV_ABI sceKernelClose(int d) {
     }
     file->is_opened = false;
     LOG_INFO(Kernel_Fs, "Closing {}", file->m_guest_name);
+    if (const u64 num_reads = file->num_reads.load(std::memory_order_relaxed); num_reads > 0) {
+        LOG_DEBUG(Kernel_Fs, "{}: {} of {} reads served from mapping, {} bytes",
+                  file->m_guest_name, file->num_mapped_reads.load(std::memory_order_relaxed),
+                  num_reads, file->mapped_bytes.load(std::memory_order_relaxed));
+    }
     h->DeleteHandle(d);
     return SCE_OK;
 }
@@ -206,9 +228,20 @@ int PS4_SYSV_ABI sceKernelUnlink(const char* path) {
 
 size_t PS4_SYSV_ABI _readv(int d, const SceKernelIovec* iov, int iovcnt) {
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
+    const auto files_lock = h->LockFiles();
     auto* file = h->GetFile(d);
     size_t total_read = 0;
     std::scoped_lock lk{file->m_mutex};
+    file->num_reads.fetch_add(1, std::memory_order_relaxed);
+    if (file->mapped.IsOpen()) {
+        for (int i = 0; i < iovcnt; i++) {
+            const size_t read =
+                ReadMapped(file, iov[i].iov_base, iov[i].iov_len, file->mapped_pos);
+            file->mapped_pos += read;
+            total_read += read;
+        }
+        return total_read;
+    }
     for (int i = 0; i < iovcnt; i++) {
         total_read += file->f.ReadRaw<u8>(iov[i].iov_base, iov[i].iov_len);
     }
@@ -229,6 +262,20 @@ s64 PS4_SYSV_ABI sceKernelLseek(int d, s64 offset, int whence) {
     }
 
     std::scoped_lock lk{file->m_mutex};
+    if (file->mapped.IsOpen()) {
+        s64 base = 0;
+        if (origin == Common::FS::SeekOrigin::CurrentPosition) {
+            base = file->mapped_pos;
+        } else if (origin == Common::FS::SeekOrigin::End) {
+            base = file->mapped.GetSize();
+        }
+        if (base + offset < 0) {
+            LOG_CRITICAL(Kernel_Fs, "sceKernelLseek: failed to seek");
+            return SCE_KERNEL_ERROR_EINVAL;
+        }
+        file->mapped_pos = base + offset;
+        return file->mapped_pos;
+    }
     if (!file->f.Seek(offset, origin)) {
         LOG_CRITICAL(Kernel_Fs, "sceKernelLseek: failed to seek");
         return SCE_KERNEL_ERROR_EINVAL;
@@ -255,12 +302,19 @@ s64 PS4_SYSV_ABI sceKernelRead(int d, void* buf, size_t nbytes) {
         return nbytes;
     }
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
+    const auto files_lock = h->LockFiles();
     auto* file = h->GetFile(d);
     if (file == nullptr) {
         return SCE_KERNEL_ERROR_EBADF;
     }
 
     std::scoped_lock lk{file->m_mutex};
+    file->num_reads.fetch_add(1, std::memory_order_relaxed);
+    if (file->mapped.IsOpen()) {
+        const size_t read = ReadMapped(file, buf, nbytes, file->mapped_pos);
+        file->mapped_pos += read;
+        return read;
+    }
     return file->f.ReadRaw<u8>(buf, nbytes);
 }
 
@@ -425,11 +479,19 @@ s64 PS4_SYSV_ABI sceKernelPread(int d, void* buf, size_t nbytes, s64 offset) {
     }
 
     auto* h = Common::Singleton<Core::FileSys::HandleTable>::Instance();
+    const auto files_lock = h->LockFiles();
     auto* file = h->GetFile(d);
     if (file == nullptr) {
         return ORBIS_KERNEL_ERROR_EBADF;
     }
 
+    file->num_reads.fetch_add(1, std::memory_order_relaxed);
+    if (file->mapped.IsOpen()) {
+        // Positional reads leave the file position alone, so they need no file lock. The files
+        // lock keeps a concurrent close from unmapping the data while it is copied.
+        return ReadMapped(file, buf, nbytes, offset);
+    }
+
     std::scoped_lock lk{file->m_mutex};
     const s64 pos = file->f.Tell();
     SCOPE_EXIT {
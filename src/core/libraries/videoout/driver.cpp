@@ -196,6 +196,7 @@ void VideoOutDriver::Flip(const Request& req) {
     if (req.index != -1) {
         port->buffer_labels[req.index] = 0;
         port->SignalVoLabel();
+        liverpool->NotifyMemoryWrite();
     }
 }
 
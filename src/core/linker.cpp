@@ -1,6 +1,8 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <chrono>
+#include <thread>
 #include "common/alignment.h"
 #include "common/arch.h"
 #include "common/assert.h"
@@ -9,6 +11,7 @@
 #include "common/path_util.h"
 #include "common/string_util.h"
 #include "common/thread.h"
+#include "common/thread_worker.h"
 #include "core/aerolib/aerolib.h"
 #include "core/aerolib/stubs.h"
 #include "core/libraries/kernel/memory.h"
@@ -48,6 +51,10 @@ static PS4_SYSV_ABI void* RunMainEntry [[noreturn]] (EntryParams* params) {
 }
 #endif
 
+static size_t NumLoaderWorkers() {
+    return std::max(std::thread::hardware_concurrency(), 1U);
+}
+
 Linker::Linker() : memory{Memory::Instance()} {}
 
 Linker::~Linker() = default;
@@ -61,10 +68,19 @@ void Linker::Execute() {
     Module* module = m_modules[0].get();
     static_tls_size = module->tls.offset = module->tls.image_size;
 
-    // Relocate all modules
-    for (const auto& m : m_modules) {
-        Relocate(m.get());
+    // Relocate all modules. Each module only patches its own image and the symbol tables are
+    // no longer modified, so modules can be relocated independently.
+    const auto relocate_start = std::chrono::steady_clock::now();
+    {
+        Common::ThreadWorker workers{NumLoaderWorkers(), "shadPS4:Relocate"};
+        for (const auto& m : m_modules) {
+            workers.QueueWork([this, module = m.get()] { Relocate(module); });
+        }
+        workers.WaitForRequests();
     }
+    const auto relocate_time = std::chrono::steady_clock::now() - relocate_start;
+    LOG_INFO(Core_Linker, "Relocated {} modules in {} ms", m_modules.size(),
+             std::chrono::duration_cast<std::chrono::milliseconds>(relocate_time).count());
 
     // Configure used flexible memory size.
     if (const auto* proc_param = GetProcParam()) {
@@ -113,6 +129,56 @@ s32 Linker::LoadModule(const std::filesystem::path& elf_name, bool is_dynamic) {
     return m_modules.size() - 1;
 }
 
+void Linker::LoadModules(std::span<const std::filesystem::path> elf_names) {
+    std::scoped_lock lk{mutex};
+
+    const auto load_start = std::chrono::steady_clock::now();
+    Common::ThreadWorker workers{NumLoaderWorkers(), "shadPS4:ModuleLoader"};
+    std::vector<std::unique_ptr<Module>> modules(elf_names.size());
+    for (size_t i = 0; i < elf_names.size(); ++i) {
+        if (!std::filesystem::exists(elf_names[i])) {
+            LOG_ERROR(Core_Linker, "Provided file {} does not exist", elf_names[i].string());
+            continue;
+        }
+        workers.QueueWork([this, &modules, &elf_names, i] {
+            modules[i] = std::make_unique<Module>(memory, elf_names[i]);
+        });
+    }
+    workers.WaitForRequests();
+
+    // Address ranges and TLS indices are handed out in load order, so they do not depend on
+    // which module finished parsing first. Mapping also registers the module with the code
+    // patcher, which has to be done for all of them before any code is patched.
+    for (auto& module : modules) {
+        if (module && module->elf.IsElfFile()) {
+            module->MapModule(max_tls_index);
+        }
+    }
+    for (auto& module : modules) {
+        if (module && module->IsValid()) {
+            workers.QueueWork([module = module.get()] { module->Load(); });
+        }
+    }
+    workers.WaitForRequests();
+
+    size_t num_loaded = 0;
+    for (auto& module : modules) {
+        if (!module) {
+            continue;
+        }
+        if (!module->IsValid()) {
+            LOG_ERROR(Core_Linker, "Provided file {} is not valid ELF file", module->file.string());
+            continue;
+        }
+        ++num_static_modules;
+        ++num_loaded;
+        m_modules.emplace_back(std::move(module));
+    }
+    const auto load_time = std::chrono::steady_clock::now() - load_start;
+    LOG_INFO(Core_Linker, "Loaded {} modules in {} ms", num_loaded,
+             std::chrono::duration_cast<std::chrono::milliseconds>(load_time).count());
+}
+
 Module* Linker::FindByAddress(VAddr address) {
     for (auto& module : m_modules) {
         const VAddr base = module->GetBaseAddress();
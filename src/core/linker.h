@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <mutex>
+#include <span>
 #include <vector>
 #include "core/libraries/kernel/threads.h"
 #include "core/module.h"
@@ -128,6 +129,9 @@ public:
     void FreeTlsForNonPrimaryThread(void* pointer);
 
     s32 LoadModule(const std::filesystem::path& elf_name, bool is_dynamic = false);
+    /// Loads the system modules the game starts with, in parallel. All of them are counted as
+    /// static modules, so it must not be used for modules loaded at runtime.
+    void LoadModules(std::span<const std::filesystem::path> elf_names);
     Module* FindByAddress(VAddr address);
 
     void Relocate(Module* module);
@@ -6,6 +6,7 @@
 #include <filesystem>
 #include <span>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "common/types.h"
 
@@ -73,6 +74,7 @@ public:
 
 private:
     std::vector<SymbolRecord> m_symbols;
+    std::unordered_map<std::string, size_t> m_symbol_index; ///< Generated name to symbol index.
 };
 
 } // namespace Core::Loader
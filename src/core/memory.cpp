@@ -5,6 +5,7 @@
 #include "common/assert.h"
 #include "common/config.h"
 #include "common/debug.h"
+#include "common/path_util.h"
 #include "core/libraries/error_codes.h"
 #include "core/libraries/kernel/memory.h"
 #include "core/memory.h"
@@ -15,7 +16,14 @@ namespace Core {
 
 constexpr u64 SCE_DEFAULT_FLEXIBLE_MEMORY_SIZE = 448_MB;
 
-MemoryManager::MemoryManager() {
+MemoryManager::MemoryManager() : MemoryManager{Config::isMemoryTraceEnabled()} {}
+
+MemoryManager::MemoryManager(bool enable_trace) {
+    if (enable_trace) {
+        const auto path = Common::FS::GetUserPath(Common::FS::PathType::LogDir);
+        trace_writer = std::make_unique<MemoryTraceWriter>(path / "memory_trace.bin");
+    }
+
     // Set up the direct and flexible memory regions.
     SetupMemoryRegions(SCE_DEFAULT_FLEXIBLE_MEMORY_SIZE);
 
@@ -31,6 +39,9 @@ MemoryManager::MemoryManager() {
     vma_map.emplace(system_reserved_base,
                     VirtualMemoryArea{system_reserved_base, system_reserved_size});
     vma_map.emplace(user_base, VirtualMemoryArea{user_base, user_size});
+    for (auto it = vma_map.begin(); it != vma_map.end(); ++it) {
+        UpdateFreeRange(it);
+    }
 
     // Log initialization.
     LOG_INFO(Kernel_Vmm, "Usable memory address space: {}_GB",
@@ -40,6 +51,9 @@ MemoryManager::MemoryManager() {
 MemoryManager::~MemoryManager() = default;
 
 void MemoryManager::SetupMemoryRegions(u64 flexible_size) {
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::SetupRegions,
+                                                .size = flexible_size}};
+
     const auto total_size =
         Config::isNeoMode() ? SCE_KERNEL_MAIN_DMEM_SIZE_PRO : SCE_KERNEL_MAIN_DMEM_SIZE;
     total_flexible_size = flexible_size;
@@ -67,6 +81,11 @@ bool MemoryManager::TryWriteBacking(void* address, const void* data, u32 num_byt
 
 PAddr MemoryManager::PoolExpand(PAddr search_start, PAddr search_end, size_t size, u64 alignment) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::PoolExpand,
+                                                .addr = search_start,
+                                                .size = size,
+                                                .phys_addr = search_end,
+                                                .alignment = alignment}};
 
     auto dmem_area = FindDmemArea(search_start);
 
@@ -91,12 +110,19 @@ PAddr MemoryManager::PoolExpand(PAddr search_start, PAddr search_end, size_t siz
     auto& area = CarveDmemArea(free_addr, size)->second;
     area.is_free = false;
     area.is_pooled = true;
+    trace.record.result = free_addr;
     return free_addr;
 }
 
 PAddr MemoryManager::Allocate(PAddr search_start, PAddr search_end, size_t size, u64 alignment,
                               int memory_type) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::Allocate,
+                                                .prot = static_cast<u32>(memory_type),
+                                                .addr = search_start,
+                                                .size = size,
+                                                .phys_addr = search_end,
+                                                .alignment = alignment}};
 
     auto dmem_area = FindDmemArea(search_start);
 
@@ -121,11 +147,14 @@ PAddr MemoryManager::Allocate(PAddr search_start, PAddr search_end, size_t size,
     auto& area = CarveDmemArea(free_addr, size)->second;
     area.memory_type = memory_type;
     area.is_free = false;
+    trace.record.result = free_addr;
     return free_addr;
 }
 
 void MemoryManager::Free(PAddr phys_addr, size_t size) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(),
+                           {.op = MemoryTraceOp::Free, .addr = phys_addr, .size = size}};
 
     auto dmem_area = CarveDmemArea(phys_addr, size);
     ASSERT(dmem_area != dmem_map.end() && dmem_area->second.size >= size);
@@ -158,6 +187,11 @@ void MemoryManager::Free(PAddr phys_addr, size_t size) {
 int MemoryManager::PoolReserve(void** out_addr, VAddr virtual_addr, size_t size,
                                MemoryMapFlags flags, u64 alignment) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::PoolReserve,
+                                                .flags = static_cast<u32>(flags),
+                                                .addr = virtual_addr,
+                                                .size = size,
+                                                .alignment = alignment}};
 
     virtual_addr = (virtual_addr == 0) ? impl.SystemManagedVirtualBase() : virtual_addr;
     alignment = alignment > 0 ? alignment : 2_MB;
@@ -177,6 +211,9 @@ int MemoryManager::PoolReserve(void** out_addr, VAddr virtual_addr, size_t size,
     // Find the first free area starting with provided virtual address.
     if (False(flags & MemoryMapFlags::Fixed)) {
         mapped_addr = SearchFree(mapped_addr, size, alignment);
+        if (mapped_addr == 0) {
+            return SCE_KERNEL_ERROR_ENOMEM;
+        }
     }
 
     // Add virtual memory area
@@ -189,12 +226,18 @@ int MemoryManager::PoolReserve(void** out_addr, VAddr virtual_addr, size_t size,
     MergeAdjacent(vma_map, new_vma_handle);
 
     *out_addr = std::bit_cast<void*>(mapped_addr);
+    trace.record.result = mapped_addr;
     return ORBIS_OK;
 }
 
 int MemoryManager::Reserve(void** out_addr, VAddr virtual_addr, size_t size, MemoryMapFlags flags,
                            u64 alignment) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::Reserve,
+                                                .flags = static_cast<u32>(flags),
+                                                .addr = virtual_addr,
+                                                .size = size,
+                                                .alignment = alignment}};
 
     virtual_addr = (virtual_addr == 0) ? impl.SystemManagedVirtualBase() : virtual_addr;
     alignment = alignment > 0 ? alignment : 16_KB;
@@ -214,6 +257,9 @@ int MemoryManager::Reserve(void** out_addr, VAddr virtual_addr, size_t size, Mem
     // Find the first free area starting with provided virtual address.
     if (False(flags & MemoryMapFlags::Fixed)) {
         mapped_addr = SearchFree(mapped_addr, size, alignment);
+        if (mapped_addr == 0) {
+            return SCE_KERNEL_ERROR_ENOMEM;
+        }
     }
 
     // Add virtual memory area
@@ -226,11 +272,16 @@ int MemoryManager::Reserve(void** out_addr, VAddr virtual_addr, size_t size, Mem
     MergeAdjacent(vma_map, new_vma_handle);
 
     *out_addr = std::bit_cast<void*>(mapped_addr);
+    trace.record.result = mapped_addr;
     return ORBIS_OK;
 }
 
 int MemoryManager::PoolCommit(VAddr virtual_addr, size_t size, MemoryProt prot) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::PoolCommit,
+                                                .prot = static_cast<u32>(prot),
+                                                .addr = virtual_addr,
+                                                .size = size}};
 
     const u64 alignment = 64_KB;
 
@@ -248,15 +299,20 @@ int MemoryManager::PoolCommit(VAddr virtual_addr, size_t size, MemoryProt prot)
     void* out_addr = impl.Map(mapped_addr, size, alignment, -1, false);
     TRACK_ALLOC(out_addr, size, "VMEM");
 
-    auto& new_vma = CarveVMA(mapped_addr, size)->second;
+    const auto new_vma_handle = CarveVMA(mapped_addr, size);
+    auto& new_vma = new_vma_handle->second;
     new_vma.disallow_merge = false;
     new_vma.prot = prot;
     new_vma.name = "";
     new_vma.type = Core::VMAType::Pooled;
     new_vma.is_exec = false;
     new_vma.phys_base = 0;
+    UpdateFreeRange(new_vma_handle);
 
-    rasterizer->MapMemory(mapped_addr, size);
+    if (rasterizer) {
+        rasterizer->MapMemory(mapped_addr, size);
+    }
+    trace.record.result = mapped_addr;
     return ORBIS_OK;
 }
 
@@ -264,6 +320,15 @@ int MemoryManager::MapMemory(void** out_addr, VAddr virtual_addr, size_t size, M
                              MemoryMapFlags flags, VMAType type, std::string_view name,
                              bool is_exec, PAddr phys_addr, u64 alignment) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::MapMemory,
+                                                .type = static_cast<u8>(type),
+                                                .is_exec = is_exec,
+                                                .flags = static_cast<u32>(flags),
+                                                .prot = static_cast<u32>(prot),
+                                                .addr = virtual_addr,
+                                                .size = size,
+                                                .phys_addr = phys_addr,
+                                                .alignment = alignment}};
 
     // Certain games perform flexible mappings on loop to determine
     // the available flexible memory size. Questionable but we need to handle this.
@@ -288,38 +353,57 @@ int MemoryManager::MapMemory(void** out_addr, VAddr virtual_addr, size_t size, M
     // Find the first free area starting with provided virtual address.
     if (False(flags & MemoryMapFlags::Fixed)) {
         mapped_addr = SearchFree(mapped_addr, size, alignment);
+        if (mapped_addr == 0) {
+            return SCE_KERNEL_ERROR_ENOMEM;
+        }
     }
 
     // Perform the mapping.
     *out_addr = impl.Map(mapped_addr, size, alignment, phys_addr, is_exec);
     TRACK_ALLOC(*out_addr, size, "VMEM");
 
-    auto& new_vma = CarveVMA(mapped_addr, size)->second;
+    const auto new_vma_handle = CarveVMA(mapped_addr, size);
+    auto& new_vma = new_vma_handle->second;
     new_vma.disallow_merge = True(flags & MemoryMapFlags::NoCoalesce);
     new_vma.prot = prot;
     new_vma.name = name;
     new_vma.type = type;
     new_vma.is_exec = is_exec;
+    UpdateFreeRange(new_vma_handle);
 
     if (type == VMAType::Direct) {
         new_vma.phys_base = phys_addr;
-        rasterizer->MapMemory(mapped_addr, size);
+        if (rasterizer) {
+            rasterizer->MapMemory(mapped_addr, size);
+        }
     }
     if (type == VMAType::Flexible) {
         flexible_usage += size;
     }
 
+    trace.record.result = mapped_addr;
     return ORBIS_OK;
 }
 
 int MemoryManager::MapFile(void** out_addr, VAddr virtual_addr, size_t size, MemoryProt prot,
                            MemoryMapFlags flags, uintptr_t fd, size_t offset) {
+    std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::MapFile,
+                                                .flags = static_cast<u32>(flags),
+                                                .prot = static_cast<u32>(prot),
+                                                .addr = virtual_addr,
+                                                .size = size,
+                                                .phys_addr = offset}};
+
     VAddr mapped_addr = (virtual_addr == 0) ? impl.SystemManagedVirtualBase() : virtual_addr;
     const size_t size_aligned = Common::AlignUp(size, 16_KB);
 
     // Find first free area to map the file.
     if (False(flags & MemoryMapFlags::Fixed)) {
         mapped_addr = SearchFree(mapped_addr, size_aligned, 1);
+        if (mapped_addr == 0) {
+            return SCE_KERNEL_ERROR_ENOMEM;
+        }
     }
 
     if (True(flags & MemoryMapFlags::Fixed)) {
@@ -332,19 +416,24 @@ int MemoryManager::MapFile(void** out_addr, VAddr virtual_addr, size_t size, Mem
     impl.MapFile(mapped_addr, size, offset, std::bit_cast<u32>(prot), fd);
 
     // Add virtual memory area
-    auto& new_vma = CarveVMA(mapped_addr, size_aligned)->second;
+    const auto new_vma_handle = CarveVMA(mapped_addr, size_aligned);
+    auto& new_vma = new_vma_handle->second;
     new_vma.disallow_merge = True(flags & MemoryMapFlags::NoCoalesce);
     new_vma.prot = prot;
     new_vma.name = "File";
     new_vma.fd = fd;
     new_vma.type = VMAType::File;
+    UpdateFreeRange(new_vma_handle);
 
     *out_addr = std::bit_cast<void*>(mapped_addr);
+    trace.record.result = mapped_addr;
     return ORBIS_OK;
 }
 
 void MemoryManager::PoolDecommit(VAddr virtual_addr, size_t size) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(),
+                           {.op = MemoryTraceOp::PoolDecommit, .addr = virtual_addr, .size = size}};
 
     const auto it = FindVMA(virtual_addr);
     const auto& vma_base = it->second;
@@ -358,7 +447,9 @@ void MemoryManager::PoolDecommit(VAddr virtual_addr, size_t size) {
     const auto start_in_vma = virtual_addr - vma_base_addr;
     const auto type = vma_base.type;
 
-    rasterizer->UnmapMemory(virtual_addr, size);
+    if (rasterizer) {
+        rasterizer->UnmapMemory(virtual_addr, size);
+    }
 
     // Mark region as free and attempt to coalesce it with neighbours.
     const auto new_it = CarveVMA(virtual_addr, size);
@@ -378,6 +469,8 @@ void MemoryManager::PoolDecommit(VAddr virtual_addr, size_t size) {
 
 void MemoryManager::UnmapMemory(VAddr virtual_addr, size_t size) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(),
+                           {.op = MemoryTraceOp::UnmapMemory, .addr = virtual_addr, .size = size}};
     UnmapMemoryImpl(virtual_addr, size);
 }
 
@@ -394,7 +487,7 @@ void MemoryManager::UnmapMemoryImpl(VAddr virtual_addr, size_t size) {
     const auto start_in_vma = virtual_addr - vma_base_addr;
     const auto type = vma_base.type;
     const bool has_backing = type == VMAType::Direct || type == VMAType::File;
-    if (type == VMAType::Direct) {
+    if (type == VMAType::Direct && rasterizer) {
         rasterizer->UnmapMemory(virtual_addr, size);
     }
     if (type == VMAType::Flexible) {
@@ -439,6 +532,10 @@ int MemoryManager::QueryProtection(VAddr addr, void** start, void** end, u32* pr
 
 int MemoryManager::Protect(VAddr addr, size_t size, MemoryProt prot) {
     std::scoped_lock lk{mutex};
+    MemoryTraceScope trace{trace_writer.get(), {.op = MemoryTraceOp::Protect,
+                                                .prot = static_cast<u32>(prot),
+                                                .addr = addr,
+                                                .size = size}};
 
     // Find the virtual memory area that contains the specified address range.
     auto it = FindVMA(addr);
@@ -489,6 +586,7 @@ int MemoryManager::Protect(VAddr addr, size_t size, MemoryProt prot) {
 
     impl.Protect(addr, size, perms);
 
+    trace.record.result = addr;
     return ORBIS_OK;
 }
 
@@ -601,23 +699,21 @@ VAddr MemoryManager::SearchFree(VAddr virtual_addr, size_t size, u32 alignment)
         return virtual_addr;
     }
     // Search for the first free VMA that fits our mapping.
-    const auto is_suitable = [&] {
-        if (!it->second.IsFree()) {
-            return false;
-        }
-        const auto& vma = it->second;
-        virtual_addr = Common::AlignUp(vma.base, alignment);
+    for (auto free_it = free_ranges.lower_bound(it->first); free_it != free_ranges.end();
+         ++free_it) {
+        const auto [free_base, free_size] = *free_it;
+        virtual_addr = Common::AlignUp(free_base, alignment);
         // Sometimes the alignment itself might be larger than the VMA.
-        if (virtual_addr > vma.base + vma.size) {
-            return false;
+        if (virtual_addr > free_base + free_size) {
+            continue;
+        }
+        const size_t remaining_size = free_base + free_size - virtual_addr;
+        if (remaining_size >= size) {
+            return virtual_addr;
         }
-        const size_t remaining_size = vma.base + vma.size - virtual_addr;
-        return remaining_size >= size;
-    };
-    while (!is_suitable()) {
-        ++it;
     }
-    return virtual_addr;
+    LOG_ERROR(Kernel_Vmm, "Unable to find free virtual memory area: size = {:#x}", size);
+    return 0;
 }
 
 MemoryManager::VMAHandle MemoryManager::CarveVMA(VAddr virtual_addr, size_t size) {
@@ -679,7 +775,10 @@ MemoryManager::VMAHandle MemoryManager::Split(VMAHandle vma_handle, size_t offse
     if (new_vma.type == VMAType::Direct) {
         new_vma.phys_base += offset_in_vma;
     }
-    return vma_map.emplace_hint(std::next(vma_handle), new_vma.base, new_vma);
+    UpdateFreeRange(vma_handle);
+    const auto new_handle = vma_map.emplace_hint(std::next(vma_handle), new_vma.base, new_vma);
+    UpdateFreeRange(new_handle);
+    return new_handle;
 }
 
 MemoryManager::DMemHandle MemoryManager::Split(DMemHandle dmem_handle, size_t offset_in_area) {
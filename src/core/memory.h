@@ -4,13 +4,16 @@
 #pragma once
 
 #include <map>
+#include <memory>
 #include <mutex>
 #include <string_view>
+#include <type_traits>
 #include "common/enum.h"
 #include "common/singleton.h"
 #include "common/types.h"
 #include "core/address_space.h"
 #include "core/libraries/kernel/memory.h"
+#include "core/memory_trace.h"
 
 namespace Vulkan {
 class Rasterizer;
@@ -125,8 +128,13 @@ class MemoryManager {
     using VMAMap = std::map<VAddr, VirtualMemoryArea>;
     using VMAHandle = VMAMap::iterator;
 
+    // Base and size of every free VMA, so searches skip over mapped areas.
+    using FreeRangeMap = std::map<VAddr, size_t>;
+
 public:
     explicit MemoryManager();
+    /// Records a memory trace in the log directory if enable_trace is set.
+    explicit MemoryManager(bool enable_trace);
     ~MemoryManager();
 
     void SetRasterizer(Vulkan::Rasterizer* rasterizer_) {
@@ -218,9 +226,13 @@ private:
 
     template <typename Handle>
     Handle MergeAdjacent(auto& handle_map, Handle iter) {
+        constexpr bool is_vma = std::is_same_v<Handle, VMAHandle>;
         const auto next_vma = std::next(iter);
         if (next_vma != handle_map.end() && iter->second.CanMergeWith(next_vma->second)) {
             iter->second.size += next_vma->second.size;
+            if constexpr (is_vma) {
+                free_ranges.erase(next_vma->first);
+            }
             handle_map.erase(next_vma);
         }
 
@@ -228,14 +240,32 @@ private:
             auto prev_vma = std::prev(iter);
             if (prev_vma->second.CanMergeWith(iter->second)) {
                 prev_vma->second.size += iter->second.size;
+                if constexpr (is_vma) {
+                    free_ranges.erase(iter->first);
+                }
                 handle_map.erase(iter);
                 iter = prev_vma;
             }
         }
 
+        if constexpr (is_vma) {
+            UpdateFreeRange(iter);
+        }
         return iter;
     }
 
+    /// Synchronizes the free range index with a VMA whose type or size has changed.
+    void UpdateFreeRange(VMAHandle handle) {
+        const auto& vma = handle->second;
+        if (vma.IsFree()) {
+            free_ranges.insert_or_assign(vma.base, vma.size);
+        } else {
+            free_ranges.erase(vma.base);
+        }
+    }
+
+    /// Returns the first free address at or after virtual_addr that fits the mapping, or zero
+    /// when the address space has no free area large enough.
     VAddr SearchFree(VAddr virtual_addr, size_t size, u32 alignment = 0);
 
     VMAHandle CarveVMA(VAddr virtual_addr, size_t size);
@@ -252,11 +282,13 @@ private:
     AddressSpace impl;
     DMemMap dmem_map;
     VMAMap vma_map;
+    FreeRangeMap free_ranges;
     std::mutex mutex;
     size_t total_direct_size{};
     size_t total_flexible_size{};
     size_t flexible_usage{};
     Vulkan::Rasterizer* rasterizer{};
+    std::unique_ptr<MemoryTraceWriter> trace_writer;
 };
 
 using Memory = Common::Singleton<MemoryManager>;
@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <fmt/core.h>
+
+#include "common/assert.h"
+#include "common/mapped_file.h"
+#include "common/path_util.h"
+#include "common/thread.h"
+#include "core/memory.h"
+#include "core/memory_trace.h"
+
+namespace Core {
+
+constexpr u32 MemoryTraceMagic = 0x52544D53; // "SMTR"
+constexpr u32 MemoryTraceVersion = 1;
+
+// Records are written in batches to keep the cost of tracing off the traced calls.
+constexpr size_t RecordBatchSize = 4096;
+constexpr auto FlushInterval = std::chrono::seconds{1};
+
+constexpr std::array<const char*, static_cast<size_t>(MemoryTraceOp::Count)> OpNames = {
+    "SetupRegions",
+    "Allocate",
+    "Free",
+    "Reserve",
+    "PoolCommit",
+    "PoolDecommit",
+    "MapMemory",
+    "UnmapMemory",
+    "Protect",
+    "PoolReserve",
+    "PoolExpand",
+    "MapFile",
+};
+
+MemoryTraceWriter::MemoryTraceWriter(const std::filesystem::path& path)
+    : file{path, Common::FS::FileAccessMode::Write} {
+    ASSERT_MSG(file.IsOpen(), "Failed to create memory trace {}", path.string());
+    file.WriteObject(MemoryTraceMagic);
+    file.WriteObject(MemoryTraceVersion);
+    records.reserve(RecordBatchSize);
+    flush_thread = std::jthread{[this](std::stop_token stop_token) { FlushThread(stop_token); }};
+}
+
+MemoryTraceWriter::~MemoryTraceWriter() {
+    flush_thread.request_stop();
+    flush_thread.join();
+    Flush();
+}
+
+void MemoryTraceWriter::Write(const MemoryTraceRecord& record) {
+    std::scoped_lock lk{mutex};
+    records.push_back(record);
+    if (records.size() == RecordBatchSize) {
+        Flush();
+    }
+}
+
+void MemoryTraceWriter::Flush() {
+    if (records.empty()) {
+        return;
+    }
+    file.WriteSpan(std::span<const MemoryTraceRecord>{records});
+    file.Flush();
+    records.clear();
+}
+
+void MemoryTraceWriter::FlushThread(std::stop_token stop_token) {
+    Common::SetCurrentThreadName("shadPS4:MemoryTrace");
+    while (Common::StoppableTimedWait(stop_token, FlushInterval)) {
+        std::scoped_lock lk{mutex};
+        Flush();
+    }
+}
+
+namespace {
+
+/// Relocates addresses of a trace to where the replayed calls placed the same ranges.
+class AddressRemap {
+public:
+    void Add(u64 traced_base, u64 size, u64 replay_base) {
+        if (traced_base == replay_base) {
+            ranges.erase(traced_base);
+            return;
+        }
+        ranges.insert_or_assign(traced_base, Range{size, replay_base});
+    }
+
+    [[nodiscard]] u64 Translate(u64 addr) const {
+        auto it = ranges.upper_bound(addr);
+        if (it == ranges.begin()) {
+            return addr;
+        }
+        --it;
+        const auto& [traced_base, range] = *it;
+        return addr < traced_base + range.size ? range.replay_base + (addr - traced_base) : addr;
+    }
+
+private:
+    struct Range {
+        u64 size;
+        u64 replay_base;
+    };
+    std::map<u64, Range> ranges;
+};
+
+/// Latencies bucketed by powers of two nanoseconds.
+struct LatencyHistogram {
+    static constexpr size_t NumBuckets = 32;
+
+    void Add(u64 ns) {
+        ++buckets[std::min<size_t>(std::bit_width(ns), NumBuckets - 1)];
+        ++count;
+        total_ns += ns;
+        max_ns = std::max(max_ns, ns);
+    }
+
+    /// Returns the upper bound of the bucket holding the requested percentile.
+    [[nodiscard]] u64 Percentile(double percent) const {
+        const u64 target = static_cast<u64>(count * percent / 100.0);
+        u64 seen = 0;
+        for (size_t i = 0; i < NumBuckets; ++i) {
+            seen += buckets[i];
+            if (seen > target) {
+                return (u64{1} << i) - 1;
+            }
+        }
+        return max_ns;
+    }
+
+    std::array<u64, NumBuckets> buckets{};
+    u64 count{};
+    u64 total_ns{};
+    u64 max_ns{};
+};
+
+void PrintHistograms(std::span<const LatencyHistogram> replayed,
+                     std::span<const LatencyHistogram> traced) {
+    for (size_t op = 0; op < replayed.size(); ++op) {
+        const auto& histogram = replayed[op];
+        if (histogram.count == 0) {
+            continue;
+        }
+        fmt::print("{}: {} calls, mean {} ns (traced {} ns), p50 <{} ns, p99 <{} ns, max {} ns\n",
+                   OpNames[op], histogram.count, histogram.total_ns / histogram.count,
+                   traced[op].total_ns / histogram.count, histogram.Percentile(50.0),
+                   histogram.Percentile(99.0), histogram.max_ns);
+        for (size_t i = 0; i < LatencyHistogram::NumBuckets; ++i) {
+            if (histogram.buckets[i] == 0) {
+                continue;
+            }
+            const u64 lower = i == 0 ? 0 : u64{1} << (i - 1);
+            fmt::print("  [{:>10}, {:>10}) ns {:>10}\n", lower, u64{1} << i,
+                       histogram.buckets[i]);
+        }
+    }
+}
+
+} // Anonymous namespace
+
+bool ReplayMemoryTrace(const std::filesystem::path& path) {
+    const Common::FS::MappedFile file{path};
+    if (!file.IsOpen()) {
+        return false;
+    }
+    auto data = file.Data();
+    u32 header[2];
+    if (data.size() < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(header, data.data(), sizeof(header));
+    if (header[0] != MemoryTraceMagic || header[1] != MemoryTraceVersion) {
+        return false;
+    }
+    data = data.subspan(sizeof(header));
+
+    // The trace starts from a freshly constructed manager, and replaying it must not record a
+    // new trace over the one being read.
+    const auto memory = std::make_unique<MemoryManager>(false);
+    AddressRemap virtual_remap;
+    AddressRemap physical_remap;
+    std::array<LatencyHistogram, static_cast<size_t>(MemoryTraceOp::Count)> replayed{};
+    std::array<LatencyHistogram, static_cast<size_t>(MemoryTraceOp::Count)> traced{};
+
+    // The traced files are not part of the trace, file mappings are backed by a scratch file
+    // large enough for all of them.
+    u64 scratch_size = 0;
+    for (size_t offset = 0; offset + sizeof(MemoryTraceRecord) <= data.size();
+         offset += sizeof(MemoryTraceRecord)) {
+        MemoryTraceRecord record;
+        std::memcpy(&record, data.data() + offset, sizeof(record));
+        if (record.op == MemoryTraceOp::MapFile) {
+            scratch_size = std::max(scratch_size, record.phys_addr + record.size);
+        }
+    }
+    const auto scratch_path =
+        Common::FS::GetUserPath(Common::FS::PathType::LogDir) / "memory_trace_replay.tmp";
+    Common::FS::IOFile scratch_file;
+    if (scratch_size != 0) {
+        // Created first, as opening for reading and writing requires an existing file.
+        Common::FS::IOFile{scratch_path, Common::FS::FileAccessMode::Write};
+        scratch_file.Open(scratch_path, Common::FS::FileAccessMode::ReadWrite);
+        if (!scratch_file.IsOpen() || !scratch_file.SetSize(scratch_size)) {
+            fmt::print("Unable to create {}\n", scratch_path.string());
+            return false;
+        }
+    }
+
+    // A trace cut short by a crash simply ends in the middle of a record.
+    bool is_valid = true;
+    while (data.size() >= sizeof(MemoryTraceRecord)) {
+        MemoryTraceRecord record;
+        std::memcpy(&record, data.data(), sizeof(record));
+        data = data.subspan(sizeof(record));
+        if (record.op >= MemoryTraceOp::Count) {
+            is_valid = false;
+            break;
+        }
+
+        const auto flags = static_cast<MemoryMapFlags>(record.flags);
+        const auto prot = static_cast<MemoryProt>(record.prot);
+        const bool is_fixed = True(flags & MemoryMapFlags::Fixed);
+        const u64 addr = is_fixed ? virtual_remap.Translate(record.addr) : record.addr;
+        void* out_addr{};
+
+        const auto start = std::chrono::steady_clock::now();
+        switch (record.op) {
+        case MemoryTraceOp::SetupRegions:
+            memory->SetupMemoryRegions(record.size);
+            break;
+        case MemoryTraceOp::Allocate: {
+            const PAddr phys_addr =
+                memory->Allocate(record.addr, record.phys_addr, record.size, record.alignment,
+                                 static_cast<int>(record.prot));
+            physical_remap.Add(record.result, record.size, phys_addr);
+            break;
+        }
+        case MemoryTraceOp::Free:
+            memory->Free(physical_remap.Translate(record.addr), record.size);
+            break;
+        case MemoryTraceOp::Reserve:
+            memory->Reserve(&out_addr, addr, record.size, flags, record.alignment);
+            break;
+        case MemoryTraceOp::PoolCommit:
+            memory->PoolCommit(virtual_remap.Translate(record.addr), record.size, prot);
+            break;
+        case MemoryTraceOp::PoolDecommit:
+            memory->PoolDecommit(virtual_remap.Translate(record.addr), record.size);
+            break;
+        case MemoryTraceOp::MapMemory: {
+            const auto type = static_cast<VMAType>(record.type);
+            const PAddr phys_addr = type == VMAType::Direct
+                                        ? physical_remap.Translate(record.phys_addr)
+                                        : record.phys_addr;
+            memory->MapMemory(&out_addr, addr, record.size, prot, flags, type, "",
+                              record.is_exec != 0, phys_addr, record.alignment);
+            break;
+        }
+        case MemoryTraceOp::UnmapMemory:
+            memory->UnmapMemory(virtual_remap.Translate(record.addr), record.size);
+            break;
+        case MemoryTraceOp::Protect:
+            memory->Protect(virtual_remap.Translate(record.addr), record.size, prot);
+            break;
+        case MemoryTraceOp::PoolReserve:
+            memory->PoolReserve(&out_addr, addr, record.size, flags, record.alignment);
+            break;
+        case MemoryTraceOp::PoolExpand: {
+            const PAddr phys_addr =
+                memory->PoolExpand(record.addr, record.phys_addr, record.size, record.alignment);
+            physical_remap.Add(record.result, record.size, phys_addr);
+            break;
+        }
+        case MemoryTraceOp::MapFile:
+            memory->MapFile(&out_addr, addr, record.size, prot, flags,
+                            scratch_file.GetFileMapping(), record.phys_addr);
+            break;
+        default:
+            UNREACHABLE();
+        }
+        const auto duration = std::chrono::steady_clock::now() - start;
+
+        if (out_addr && record.result) {
+            virtual_remap.Add(record.result, record.size, std::bit_cast<VAddr>(out_addr));
+        }
+        const auto op = static_cast<size_t>(record.op);
+        replayed[op].Add(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+        traced[op].Add(record.duration_ns);
+    }
+
+    if (scratch_file.IsOpen()) {
+        scratch_file.Close();
+        std::error_code ec;
+        std::filesystem::remove(scratch_path, ec);
+    }
+    if (!is_valid) {
+        return false;
+    }
+    PrintHistograms(replayed, traced);
+    return true;
+}
+
+} // namespace Core
@@ -0,0 +1,108 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <vector>
+
+#include "common/io_file.h"
+#include "common/polyfill_thread.h"
+#include "common/types.h"
+
+namespace Core {
+
+enum class MemoryTraceOp : u8 {
+    SetupRegions,
+    Allocate,
+    Free,
+    Reserve,
+    PoolCommit,
+    PoolDecommit,
+    MapMemory,
+    UnmapMemory,
+    Protect,
+    PoolReserve,
+    PoolExpand,
+    MapFile,
+    Count,
+};
+
+/**
+ * Arguments and outcome of a MemoryManager call. Allocate and PoolExpand store their search range
+ * in addr and phys_addr and Allocate the memory type in prot. MapFile stores the file offset in
+ * phys_addr. The other operations use the fields they are named after.
+ */
+struct MemoryTraceRecord {
+    MemoryTraceOp op{};
+    u8 type{}; ///< VMAType of the mapping.
+    u8 is_exec{};
+    u8 reserved{};
+    u32 flags{}; ///< MemoryMapFlags of the mapping.
+    u32 prot{};
+    u32 duration_ns{};
+    u64 addr{};
+    u64 size{};
+    u64 phys_addr{};
+    u64 alignment{};
+    u64 result{}; ///< Address returned by the call, zero when it failed.
+};
+static_assert(sizeof(MemoryTraceRecord) == 56);
+
+/**
+ * Appends records of memory manager calls to a trace file in the log directory. Records are
+ * written in batches, and a background thread flushes a partial batch every second so that a
+ * crash loses at most the last second of the trace.
+ */
+class MemoryTraceWriter {
+public:
+    explicit MemoryTraceWriter(const std::filesystem::path& path);
+    ~MemoryTraceWriter();
+
+    void Write(const MemoryTraceRecord& record);
+
+private:
+    void Flush();
+    void FlushThread(std::stop_token stop_token);
+
+    Common::FS::IOFile file;
+    std::mutex mutex;
+    std::vector<MemoryTraceRecord> records;
+    std::jthread flush_thread;
+};
+
+/// Times a memory manager call and writes its record when leaving the scope.
+class MemoryTraceScope {
+public:
+    explicit MemoryTraceScope(MemoryTraceWriter* writer_, const MemoryTraceRecord& record_)
+        : record{record_}, writer{writer_} {
+        if (writer) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~MemoryTraceScope() {
+        if (writer) {
+            const auto duration = std::chrono::steady_clock::now() - start;
+            record.duration_ns = static_cast<u32>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count());
+            writer->Write(record);
+        }
+    }
+
+    MemoryTraceScope(const MemoryTraceScope&) = delete;
+    MemoryTraceScope& operator=(const MemoryTraceScope&) = delete;
+
+    MemoryTraceRecord record;
+
+private:
+    MemoryTraceWriter* writer;
+    std::chrono::steady_clock::time_point start;
+};
+
+/// Replays a trace against the memory manager and prints the latency of every operation.
+bool ReplayMemoryTrace(const std::filesystem::path& path);
+
+} // namespace Core
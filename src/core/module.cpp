@@ -83,15 +83,18 @@ static std::string StringToNid(std::string_view symbol) {
 }
 
 Module::Module(Core::MemoryManager* memory_, const std::filesystem::path& file_, u32& max_tls_index)
-    : memory{memory_}, file{file_}, name{file.stem().string()} {
-    elf.Open(file);
+    : Module{memory_, file_} {
     if (elf.IsElfFile()) {
-        LoadModuleToMemory(max_tls_index);
-        LoadDynamicInfo();
-        LoadSymbols();
+        MapModule(max_tls_index);
+        Load();
     }
 }
 
+Module::Module(Core::MemoryManager* memory_, const std::filesystem::path& file_)
+    : memory{memory_}, file{file_}, name{file.stem().string()} {
+    elf.Open(file);
+}
+
 Module::~Module() = default;
 
 s32 Module::Start(size_t args, const void* argp, void* param) {
@@ -100,7 +103,7 @@ s32 Module::Start(size_t args, const void* argp, void* param) {
     return ExecuteGuest(reinterpret_cast<EntryFunc>(addr), args, argp, param);
 }
 
-void Module::LoadModuleToMemory(u32& max_tls_index) {
+void Module::MapModule(u32& max_tls_index) {
     static constexpr size_t BlockAlign = 0x1000;
     static constexpr u64 TrampolineSize = 8_MB;
 
@@ -124,6 +127,24 @@ void Module::LoadModuleToMemory(u32& max_tls_index) {
     RegisterPatchModule(*out_addr, aligned_base_size, trampoline_addr, TrampolineSize);
 #endif
 
+    for (u16 i = 0; i < elf_header.e_phnum; i++) {
+        if (elf_pheader[i].p_type == PT_TLS) {
+            tls.modid = ++max_tls_index;
+        }
+    }
+}
+
+void Module::Load() {
+    LoadModuleToMemory();
+    LoadDynamicInfo();
+    LoadSymbols();
+}
+
+void Module::LoadModuleToMemory() {
+    const auto elf_header = elf.GetElfHeader();
+    const auto elf_pheader = elf.GetProgramHeader();
+    const u64 base_size = CalculateBaseSize(elf_header, elf_pheader);
+
     LOG_INFO(Core_Linker, "======== Load Module to Memory ========");
     LOG_INFO(Core_Linker, "base_virtual_addr ......: {:#018x}", base_virtual_addr);
     LOG_INFO(Core_Linker, "base_size ..............: {:#018x}", base_size);
@@ -192,7 +213,6 @@ void Module::LoadModuleToMemory(u32& max_tls_index) {
             tls.align = elf_pheader[i].p_align;
             tls.image_virtual_addr = elf_pheader[i].p_vaddr + base_virtual_addr;
             tls.image_size = GetAlignedSize(elf_pheader[i]);
-            tls.modid = ++max_tls_index;
             LOG_INFO(Core_Linker, "TLS virtual address = {:#x}", tls.image_virtual_addr);
             LOG_INFO(Core_Linker, "TLS image size      = {}", tls.image_size);
             break;
@@ -223,8 +243,9 @@ void Module::LoadModuleToMemory(u32& max_tls_index) {
     const VAddr entry_addr = base_virtual_addr + elf.GetElfEntry();
     LOG_INFO(Core_Linker, "program entry addr ..........: {:#018x}", entry_addr);
 
-    if (MemoryPatcher::g_eboot_address == 0) {
-        if (name == "eboot") {
+    // Checked by name first, so that only the eboot ever touches the patcher state.
+    if (name == "eboot") {
+        if (MemoryPatcher::g_eboot_address == 0) {
             MemoryPatcher::g_eboot_address = base_virtual_addr;
             MemoryPatcher::g_eboot_image_size = base_size;
             MemoryPatcher::OnGameLoaded();
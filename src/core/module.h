@@ -143,6 +143,8 @@ class Module {
 public:
     explicit Module(Core::MemoryManager* memory, const std::filesystem::path& file,
                     u32& max_tls_index);
+    /// Opens the module file only, it is mapped and loaded by MapModule and Load.
+    explicit Module(Core::MemoryManager* memory, const std::filesystem::path& file);
     ~Module();
 
     VAddr GetBaseAddress() const noexcept {
@@ -204,7 +206,15 @@ public:
     }
 
     s32 Start(size_t args, const void* argp, void* param);
-    void LoadModuleToMemory(u32& max_tls_index);
+
+    /// Reserves the address range and TLS index of the module, must be called in load order.
+    void MapModule(u32& max_tls_index);
+
+    /// Reads the segments and dynamic tables into the mapped range. Modules that have been mapped
+    /// can be loaded in parallel.
+    void Load();
+
+    void LoadModuleToMemory();
     void LoadDynamicInfo();
     void LoadSymbols();
 
@@ -223,11 +223,11 @@ void Emulator::Run(const std::filesystem::path& file) {
     // Initialize kernel and library facilities.
     Libraries::InitHLELibs(&linker->GetHLESymbols());
 
-    // Load the module with the linker
-    linker->LoadModule(eboot_path);
+    // Gather the modules to load, the eboot has to come first.
+    std::vector<std::filesystem::path> modules{eboot_path};
 
     // check if we have system modules to load
-    LoadSystemModules(eboot_path, game_info.game_serial);
+    LoadSystemModules(eboot_path, game_info.game_serial, modules);
 
     // Load all prx from game's sce_module folder
     std::filesystem::path sce_module_folder = file.parent_path() / "sce_module";
@@ -240,10 +240,13 @@ void Emulator::Run(const std::filesystem::path& file) {
                 module_path = update_module_path;
             }
             LOG_INFO(Loader, "Loading {}", fmt::UTF(module_path.u8string()));
-            linker->LoadModule(module_path);
+            modules.push_back(module_path);
         }
     }
 
+    // Load all modules with the linker
+    linker->LoadModules(modules);
+
 #ifdef ENABLE_DISCORD_RPC
     // Discord RPC
     if (Config::getEnableDiscordRPC()) {
@@ -269,7 +272,8 @@ void Emulator::Run(const std::filesystem::path& file) {
     std::exit(0);
 }
 
-void Emulator::LoadSystemModules(const std::filesystem::path& file, std::string game_serial) {
+void Emulator::LoadSystemModules(const std::filesystem::path& file, std::string game_serial,
+                                 std::vector<std::filesystem::path>& modules) {
     constexpr std::array<SysModules, 11> ModulesToLoad{
         {{"libSceNgs2.sprx", &Libraries::Ngs2::RegisterlibSceNgs2},
          {"libSceFiber.sprx", &Libraries::Fiber::RegisterlibSceFiber},
@@ -293,7 +297,7 @@ void Emulator::LoadSystemModules(const std::filesystem::path& file, std::string
             found_modules, [&](const auto& path) { return path.filename() == module_name; });
         if (it != found_modules.end()) {
             LOG_INFO(Loader, "Loading {}", it->string());
-            linker->LoadModule(*it);
+            modules.push_back(*it);
             continue;
         }
         if (init_func) {
@@ -308,7 +312,7 @@ void Emulator::LoadSystemModules(const std::filesystem::path& file, std::string
              std::filesystem::directory_iterator(sys_module_path / game_serial)) {
             LOG_INFO(Loader, "Loading {} from game serial file {}", entry.path().string(),
                      game_serial);
-            linker->LoadModule(entry.path());
+            modules.push_back(entry.path());
         }
     }
 }
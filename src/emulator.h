@@ -29,7 +29,8 @@ public:
     void UpdatePlayTime(const std::string& serial);
 
 private:
-    void LoadSystemModules(const std::filesystem::path& file, std::string game_serial);
+    void LoadSystemModules(const std::filesystem::path& file, std::string game_serial,
+                           std::vector<std::filesystem::path>& modules);
 
     Core::MemoryManager* memory;
     Input::GameController* controller;
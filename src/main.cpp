@@ -8,7 +8,11 @@
 
 #include <fmt/core.h>
 #include "common/config.h"
+#include "common/logging/binary_log.h"
 #include "common/memory_patcher.h"
+#include "common/path_util.h"
+#include "core/memory_trace.h"
+#include "shader_recompiler/replay.h"
 #include "emulator.h"
 
 #ifdef _WIN32
@@ -32,7 +36,12 @@ int main(int argc, char* argv[]) {
                           "  -g, --game <path|ID>          Specify game path to launch\n"
                           "  -p, --patch <patch_file>      Apply specified patch file\n"
                           "  -f, --fullscreen <true|false> Specify window initial fullscreen "
-                          "state. Does not overwrite the config file."
+                          "state. Does not overwrite the config file.\n"
+                          "  --decode-log <log.bin>        Convert a binary log to text\n"
+                          "  --replay-memory-trace <trace.bin> Replay a memory trace and print "
+                          "call latencies\n"
+                          "  --recompile-shaders <dir>     Recompile dumped shaders and print "
+                          "pass timings\n"
                           "  -h, --help                    Display this help message\n";
              exit(0);
          }},
@@ -81,6 +90,48 @@ int main(int argc, char* argv[]) {
              Config::setFullscreenMode(is_fullscreen);
          }},
         {"--fullscreen", [&](int& i) { arg_map["-f"](i); }},
+        {"--decode-log",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --decode-log\n";
+                 exit(1);
+             }
+             const std::filesystem::path input{argv[i]};
+             const auto output = std::filesystem::path{input}.replace_extension(".txt");
+             if (!Common::Log::DecodeBinaryLog(input, output)) {
+                 std::cerr << "Error: Failed to decode binary log " << input << "\n";
+                 exit(1);
+             }
+             exit(0);
+         }},
+        {"--recompile-shaders",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --recompile-shaders\n";
+                 exit(1);
+             }
+             // Disabled shader passes apply to the replay, which must not dump shaders itself.
+             const auto config_dir = Common::FS::GetUserPath(Common::FS::PathType::UserDir);
+             Config::load(config_dir / "config.toml");
+             Config::setDumpShaders(false);
+             exit(Shader::RecompileShaderDumps(argv[i]) ? 0 : 1);
+         }},
+        {"--replay-memory-trace",
+         [&](int& i) {
+             if (++i >= argc) {
+                 std::cerr << "Error: Missing argument for --replay-memory-trace\n";
+                 exit(1);
+             }
+             // The memory layout depends on the configuration.
+             const auto config_dir = Common::FS::GetUserPath(Common::FS::PathType::UserDir);
+             Config::load(config_dir / "config.toml");
+             const std::filesystem::path input{argv[i]};
+             if (!Core::ReplayMemoryTrace(input)) {
+                 std::cerr << "Error: Failed to replay memory trace " << input << "\n";
+                 exit(1);
+             }
+             exit(0);
+         }},
     };
 
     if (argc == 1) {
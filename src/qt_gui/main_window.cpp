@@ -841,7 +841,20 @@ void MainWindow::InstallDragDropPkg(std::filesystem::path file, int pkgNum, int
                 dialog.setRange(0, nfiles);
 
                 QFutureWatcher<void> futureWatcher;
+                const auto* watcher = &futureWatcher;
                 connect(&futureWatcher, &QFutureWatcher<void>::finished, this, [=, this]() {
+                    // A cancelled or failed extraction keeps its journal in the install
+                    // directory, installing the same package again resumes it.
+                    if (watcher->isCanceled()) {
+                        return;
+                    }
+                    if (const u32 num_failed = pkg.GetNumberOfFailedFiles(); num_failed != 0) {
+                        QMessageBox::critical(
+                            this, tr("PKG ERROR"),
+                            QString(tr("Failed to extract %1 files, check the log for details"))
+                                .arg(num_failed));
+                        return;
+                    }
                     if (pkgNum == nPkg) {
                         QString path;
                         Common::FS::PathToQString(path, game_install_dir);
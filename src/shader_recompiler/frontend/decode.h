@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <span>
 #include "shader_recompiler/frontend/instruction.h"
 
 namespace Shader::Gcn {
@@ -16,6 +17,18 @@ struct InstFormat {
     ScalarType dst_type = ScalarType::Undefined;
 };
 
+/// Properties shared by all instructions of an encoding.
+struct EncodingInfo {
+    InstEncoding encoding = InstEncoding::ILLEGAL;
+    u32 length = 0;        ///< Length of the instruction without literal constant, in bytes.
+    u32 op_map_offset = 0; ///< Offset of the encoding's opcodes in the Opcode enumeration.
+    std::span<const InstFormat> formats; ///< Formats indexed by the encoding specific opcode.
+};
+
+/// Looks up the encoding of the instruction starting with the token from its top 9 bits, which
+/// hold the encoding prefixes of every format.
+const EncodingInfo& GetEncodingInfo(u32 token);
+
 InstEncoding GetInstructionEncoding(u32 token);
 
 u32 GetEncodingLength(InstEncoding encoding);
@@ -48,6 +61,10 @@ public:
         return m_ptr == m_end;
     }
 
+    const u32* position() const {
+        return m_ptr;
+    }
+
 private:
     const u32* m_ptr{};
     const u32* m_end{};
@@ -58,10 +75,8 @@ public:
     GcnInst decodeInstruction(GcnCodeSlice& code);
 
 private:
-    uint32_t getEncodingLength(InstEncoding encoding);
-    uint32_t getOpMapOffset(InstEncoding encoding);
-    uint32_t mapEncodingOp(InstEncoding encoding, Opcode opcode);
-    void updateInstructionMeta(InstEncoding encoding);
+    uint32_t mapEncodingOp(const EncodingInfo& info, Opcode opcode);
+    void updateInstructionMeta(const EncodingInfo& info);
     uint32_t getMimgModifier(Opcode opcode);
     void repairOperandType();
 
@@ -69,7 +84,7 @@ private:
 
     void decodeInstruction32(InstEncoding encoding, GcnCodeSlice& code);
     void decodeInstruction64(InstEncoding encoding, GcnCodeSlice& code);
-    void decodeLiteralConstant(InstEncoding encoding, GcnCodeSlice& code);
+    void decodeLiteralConstant(const EncodingInfo& info, GcnCodeSlice& code);
 
     // 32 bits encodings
     void decodeInstructionSOP1(uint32_t hexInstruction);
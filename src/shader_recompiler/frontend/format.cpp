@@ -3684,6 +3684,102 @@ constexpr std::array<InstFormat, 1> InstructionFormatEXP = {{
     {InstClass::Exp, InstCategory::Export, 4, 1, ScalarType::Float32, ScalarType::Any},
 }};
 
+namespace {
+
+/// Encoding prefixes in the order they are tested, longest first. Prefixes of equal length
+/// are disjoint.
+constexpr std::array<std::pair<EncodingMask, InstEncoding>, 16> EncodingPrefixes = {{
+    {EncodingMask::MASK_9bit, InstEncoding::SOP1},
+    {EncodingMask::MASK_9bit, InstEncoding::SOPP},
+    {EncodingMask::MASK_9bit, InstEncoding::SOPC},
+    {EncodingMask::MASK_7bit, InstEncoding::VOP1},
+    {EncodingMask::MASK_7bit, InstEncoding::VOPC},
+    {EncodingMask::MASK_6bit, InstEncoding::VOP3},
+    {EncodingMask::MASK_6bit, InstEncoding::EXP},
+    {EncodingMask::MASK_6bit, InstEncoding::VINTRP},
+    {EncodingMask::MASK_6bit, InstEncoding::DS},
+    {EncodingMask::MASK_6bit, InstEncoding::MUBUF},
+    {EncodingMask::MASK_6bit, InstEncoding::MTBUF},
+    {EncodingMask::MASK_6bit, InstEncoding::MIMG},
+    {EncodingMask::MASK_5bit, InstEncoding::SMRD},
+    {EncodingMask::MASK_4bit, InstEncoding::SOPK},
+    {EncodingMask::MASK_2bit, InstEncoding::SOP2},
+    {EncodingMask::MASK_1bit, InstEncoding::VOP2},
+}};
+
+constexpr InstEncoding EncodingFromPrefix(u32 token) {
+    for (const auto& [mask, encoding] : EncodingPrefixes) {
+        if ((token & static_cast<u32>(mask)) == static_cast<u32>(encoding)) {
+            return encoding;
+        }
+    }
+    return InstEncoding::ILLEGAL;
+}
+
+constexpr EncodingInfo MakeEncodingInfo(InstEncoding encoding) {
+    const auto info = [encoding](u32 length, OpcodeMap op_map,
+                                 std::span<const InstFormat> formats) {
+        return EncodingInfo{encoding, length, static_cast<u32>(op_map), formats};
+    };
+    switch (encoding) {
+    case InstEncoding::SOP1:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_SOP1, InstructionFormatSOP1);
+    case InstEncoding::SOPP:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_SOPP, InstructionFormatSOPP);
+    case InstEncoding::SOPC:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_SOPC, InstructionFormatSOPC);
+    case InstEncoding::VOP1:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_VOP1, InstructionFormatVOP1);
+    case InstEncoding::VOPC:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_VOPC, InstructionFormatVOPC);
+    case InstEncoding::VOP3:
+        return info(sizeof(u64), OpcodeMap::OP_MAP_VOP3, InstructionFormatVOP3);
+    case InstEncoding::EXP:
+        return info(sizeof(u64), OpcodeMap::OP_MAP_EXP, InstructionFormatEXP);
+    case InstEncoding::VINTRP:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_VINTRP, InstructionFormatVINTRP);
+    case InstEncoding::DS:
+        return info(sizeof(u64), OpcodeMap::OP_MAP_DS, InstructionFormatDS);
+    case InstEncoding::MUBUF:
+        return info(sizeof(u64), OpcodeMap::OP_MAP_MUBUF, InstructionFormatMUBUF);
+    case InstEncoding::MTBUF:
+        return info(sizeof(u64), OpcodeMap::OP_MAP_MTBUF, InstructionFormatMTBUF);
+    case InstEncoding::MIMG:
+        return info(sizeof(u64), OpcodeMap::OP_MAP_MIMG, InstructionFormatMIMG);
+    case InstEncoding::SMRD:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_SMRD, InstructionFormatSMRD);
+    case InstEncoding::SOPK:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_SOPK, InstructionFormatSOPK);
+    case InstEncoding::SOP2:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_SOP2, InstructionFormatSOP2);
+    case InstEncoding::VOP2:
+        return info(sizeof(u32), OpcodeMap::OP_MAP_VOP2, InstructionFormatVOP2);
+    default:
+        return {};
+    }
+}
+
+constexpr u32 EncodingPrefixShift = 23;
+
+constexpr auto EncodingTable = [] {
+    std::array<EncodingInfo, 1U << (32 - EncodingPrefixShift)> table{};
+    for (u32 prefix = 0; prefix < table.size(); ++prefix) {
+        table[prefix] = MakeEncodingInfo(EncodingFromPrefix(prefix << EncodingPrefixShift));
+    }
+    return table;
+}();
+
+static_assert(EncodingTable[static_cast<u32>(InstEncoding::SOPP) >> EncodingPrefixShift]
+                  .encoding == InstEncoding::SOPP);
+static_assert(EncodingTable[static_cast<u32>(InstEncoding::VOP2) >> EncodingPrefixShift]
+                  .encoding == InstEncoding::VOP2);
+
+} // Anonymous namespace
+
+const EncodingInfo& GetEncodingInfo(u32 token) {
+    return EncodingTable[token >> EncodingPrefixShift];
+}
+
 InstFormat InstructionFormat(InstEncoding encoding, uint32_t opcode) {
     switch (encoding) {
     case InstEncoding::SOP1:
@@ -825,11 +825,12 @@ private:
 
 IR::AbstractSyntaxList BuildASL(Common::ObjectPool<IR::Inst>& inst_pool,
                                 Common::ObjectPool<IR::Block>& block_pool, CFG& cfg, Info& info,
-                                const RuntimeInfo& runtime_info, const Profile& profile) {
+                                const RuntimeInfo& runtime_info, const Profile& profile,
+                                std::pmr::memory_resource* resource) {
     Common::ObjectPool<Statement> stmt_pool{64};
     GotoPass goto_pass{cfg, stmt_pool};
     Statement& root{goto_pass.RootStatement()};
-    IR::AbstractSyntaxList syntax_list;
+    IR::AbstractSyntaxList syntax_list{resource};
     TranslatePass{inst_pool,     block_pool, stmt_pool,    root,   syntax_list,
                   cfg.inst_list, info,       runtime_info, profile};
     ASSERT_MSG(!info.translation_failed, "Shader translation has failed");
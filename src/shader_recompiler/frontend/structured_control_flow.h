@@ -19,6 +19,7 @@ namespace Shader::Gcn {
 [[nodiscard]] IR::AbstractSyntaxList BuildASL(Common::ObjectPool<IR::Inst>& inst_pool,
                                               Common::ObjectPool<IR::Block>& block_pool, CFG& cfg,
                                               Info& info, const RuntimeInfo& runtime_info,
-                                              const Profile& profile);
+                                              const Profile& profile,
+                                              std::pmr::memory_resource* resource);
 
 } // namespace Shader::Gcn
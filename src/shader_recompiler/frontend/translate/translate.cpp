@@ -375,6 +375,7 @@ void Translator::EmitFetch(const GcnInst& inst) {
     // Parse the assembly to generate a list of attributes.
     u32 fetch_size{};
     const auto fetch_data = ParseFetchShader(code, &fetch_size);
+    info.has_fetch_shader = true;
 
     if (Config::dumpShaders()) {
         using namespace Common::FS;
@@ -189,6 +189,9 @@ struct Info {
 
     PersistentSrtInfo srt_info;
     std::vector<u32> flattened_ud_buf;
+    /// Flattened user data captured with a shader dump, used instead of walking guest memory
+    /// when the shader is recompiled offline.
+    std::span<const u32> replay_ud_buf;
 
     std::span<const u32> user_data;
     Stage stage;
@@ -210,6 +213,7 @@ struct Info {
     bool uses_step_rates{};
     bool translation_failed{}; // indicates that shader has unsupported instructions
     bool has_readconst{};
+    bool has_fetch_shader{}; // vertex attributes were read from the guest fetch shader
     u8 mrt_mask{0u};
 
     explicit Info(Stage stage_, ShaderParams params)
@@ -265,6 +269,12 @@ struct Info {
 
     void RefreshFlatBuf() {
         flattened_ud_buf.resize(srt_info.flattened_bufsize_dw);
+        if (!replay_ud_buf.empty()) {
+            std::copy_n(replay_ud_buf.begin(),
+                        std::min(replay_ud_buf.size(), flattened_ud_buf.size()),
+                        flattened_ud_buf.begin());
+            return;
+        }
         ASSERT(user_data.size() <= NumUserDataRegs);
         std::memcpy(flattened_ud_buf.data(), user_data.data(), user_data.size_bytes());
         // Run the JIT program to walk the SRT and write the leaves to a flat buffer
@@ -5,6 +5,7 @@
 
 #include <initializer_list>
 #include <map>
+#include <memory_resource>
 #include <span>
 #include <vector>
 #include <boost/intrusive/list.hpp>
@@ -171,7 +172,7 @@ private:
     u32 definition{};
 };
 
-using BlockList = std::vector<Block*>;
+using BlockList = std::pmr::vector<Block*>;
 
 [[nodiscard]] std::string DumpBlock(const Block& block);
 
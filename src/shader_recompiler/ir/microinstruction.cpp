@@ -98,6 +98,23 @@ bool Inst::MayHaveSideEffects() const noexcept {
     }
 }
 
+bool Inst::IsPure() const noexcept {
+    // Vector utilities, selects, bitcasts, floating-point, integer, logical and conversion
+    // operations are contiguous in the opcode list.
+    if (op >= Opcode::CompositeConstructU32x2 && op <= Opcode::ConvertU32U16) {
+        return true;
+    }
+    switch (op) {
+    case Opcode::ReadConst:
+    case Opcode::GetUserData:
+    case Opcode::GetAttribute:
+    case Opcode::GetAttributeU32:
+        return true;
+    default:
+        return false;
+    }
+}
+
 bool Inst::AreAllArgsImmediates() const {
     if (op == Opcode::Phi) {
         UNREACHABLE_MSG("Testing for all arguments are immediates on phi instruction");
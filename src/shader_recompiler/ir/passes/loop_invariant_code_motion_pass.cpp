@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+#include "shader_recompiler/ir/program.h"
+
+namespace Shader::Optimization {
+
+namespace {
+
+void HoistLoopInvariants(const IR::AbstractSyntaxList& syntax_list, size_t loop_index) {
+    // The structurizer places the loop header block right before the loop node, and the only
+    // other predecessor of the header is the continue block.
+    const IR::AbstractSyntaxNode& header_node = syntax_list[loop_index - 1];
+    if (header_node.type != IR::AbstractSyntaxNode::Type::Block) {
+        return;
+    }
+    IR::Block* const header = header_node.data.block;
+    const auto preds = header->ImmPredecessors();
+    const IR::Block* const continue_block = syntax_list[loop_index].data.loop.continue_block;
+    const auto preheader_it = std::ranges::find_if(
+        preds, [continue_block](const IR::Block* pred) { return pred != continue_block; });
+    if (preds.size() != 2 || preheader_it == preds.end()) {
+        return;
+    }
+    IR::Block* const preheader = *preheader_it;
+    if (preheader->ImmSuccessors().size() != 1) {
+        return;
+    }
+
+    // Loops are emitted as do-while, the header only holds phis and falls through to the first
+    // block of the body. Both run whenever the loop is entered.
+    const IR::Block* body_entry = nullptr;
+    if (const IR::AbstractSyntaxNode& body_node = syntax_list[loop_index + 1];
+        body_node.type == IR::AbstractSyntaxNode::Type::Block &&
+        header->ImmSuccessors().size() == 1 && header->ImmSuccessors()[0] == body_node.data.block) {
+        body_entry = body_node.data.block;
+    }
+
+    // Blocks of the loop, from its header up to the repeat node that branches back to it.
+    std::vector<IR::Block*> blocks;
+    for (size_t i = loop_index - 1; i < syntax_list.size(); ++i) {
+        const IR::AbstractSyntaxNode& node = syntax_list[i];
+        if (node.type == IR::AbstractSyntaxNode::Type::Block) {
+            blocks.push_back(node.data.block);
+        } else if (node.type == IR::AbstractSyntaxNode::Type::Repeat &&
+                   node.data.repeat.loop_header == header) {
+            break;
+        }
+    }
+    std::unordered_set<const IR::Inst*> loop_insts;
+    for (const IR::Block* block : blocks) {
+        for (const IR::Inst& inst : *block) {
+            loop_insts.insert(&inst);
+        }
+    }
+
+    const auto is_invariant = [&](const IR::Value& arg) {
+        return arg.IsImmediate() || !loop_insts.contains(arg.Inst());
+    };
+    for (IR::Block* const block : blocks) {
+        for (auto it = block->begin(); it != block->end();) {
+            IR::Inst& inst = *it;
+            // Reads are only hoisted from blocks that run whenever the loop is entered.
+            const bool is_read = inst.GetOpcode() == IR::Opcode::ReadConst;
+            if (!inst.IsPure() || (is_read && block != header && block != body_entry)) {
+                ++it;
+                continue;
+            }
+            // A hoisted instruction must not refer to an identity left behind in the loop.
+            bool invariant = true;
+            for (size_t i = 0; i < inst.NumArgs() && invariant; ++i) {
+                IR::Value arg;
+                while ((arg = inst.Arg(i)).IsIdentity()) {
+                    inst.SetArg(i, arg.Inst()->Arg(0));
+                }
+                invariant = is_invariant(arg);
+            }
+            if (!invariant) {
+                ++it;
+                continue;
+            }
+            it = block->Instructions().erase(it);
+            preheader->Instructions().push_back(inst);
+            loop_insts.erase(&inst);
+        }
+    }
+}
+
+} // Anonymous namespace
+
+void LoopInvariantCodeMotionPass(IR::Program& program) {
+    // Inner loops come after their outer loop in the syntax list. Visiting them first lets an
+    // invariant hoisted into the preheader of an inner loop move out of the outer one as well.
+    const IR::AbstractSyntaxList& syntax_list = program.syntax_list;
+    for (size_t i = syntax_list.size(); i-- > 1;) {
+        if (syntax_list[i].type == IR::AbstractSyntaxNode::Type::Loop) {
+            HoistLoopInvariants(syntax_list, i);
+        }
+    }
+}
+
+} // namespace Shader::Optimization
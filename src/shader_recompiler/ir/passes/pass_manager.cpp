@@ -0,0 +1,45 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include "common/config.h"
+#include "shader_recompiler/ir/passes/pass_manager.h"
+
+namespace Shader::Optimization {
+
+PassManager::PassManager(const IR::Program& program_, TranslationStats* stats_)
+    : program{program_}, stats{stats_}, count_insts{stats != nullptr || IsProfilerConnected()},
+      start{std::chrono::steady_clock::now()} {}
+
+void PassManager::Lap(std::string_view name) {
+    const auto now = std::chrono::steady_clock::now();
+    Record(name, now - start, 0);
+}
+
+size_t PassManager::CountInstructions() const {
+    size_t num_insts = 0;
+    for (const IR::Block* block : program.blocks) {
+        num_insts += block->size();
+    }
+    return num_insts;
+}
+
+bool PassManager::IsDisabled(std::string_view name) {
+    const auto& disabled = Config::getDisabledShaderPasses();
+    return std::ranges::find(disabled, name) != disabled.end();
+}
+
+void PassManager::Record(std::string_view name, std::chrono::nanoseconds time,
+                         s64 removed_insts) {
+    if (stats) {
+        stats->passes.push_back({
+            .name = name,
+            .time = time,
+            .removed_insts = removed_insts,
+        });
+    }
+    // Bookkeeping between passes is not attributed to the next stage.
+    start = std::chrono::steady_clock::now();
+}
+
+} // namespace Shader::Optimization
@@ -0,0 +1,76 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include "common/debug.h"
+#include "shader_recompiler/ir/program.h"
+#include "shader_recompiler/recompiler.h"
+
+namespace Shader::Optimization {
+
+/**
+ * Runs the stages of a translation in order. Each pass gets its own profiler zone and plot of
+ * the instructions it removed, and is recorded in the translation stats when those are requested.
+ * Passes that correctness does not depend on can be disabled from the config to bisect
+ * miscompiles.
+ */
+class PassManager {
+public:
+    explicit PassManager(const IR::Program& program_, TranslationStats* stats_);
+
+    /// Attributes the time since the previous stage to a stage that is not an IR pass.
+    void Lap(std::string_view name);
+
+    /// Runs a pass that translation cannot do without.
+    template <typename Func>
+    void Run(const char* name, Func&& pass) {
+        ZoneScopedC(RendererMarkerColor);
+        ZoneName(name, std::strlen(name));
+        const size_t num_before = count_insts ? CountInstructions() : 0;
+        const auto pass_start = std::chrono::steady_clock::now();
+        pass();
+        const auto pass_time = std::chrono::steady_clock::now() - pass_start;
+        const s64 removed_insts =
+            count_insts ? static_cast<s64>(num_before) - static_cast<s64>(CountInstructions()) : 0;
+        TracyPlot(name, removed_insts);
+        Record(name, pass_time, removed_insts);
+    }
+
+    /// Runs a pass unless it is listed in the disabled shader passes of the config. Only for
+    /// passes that later stages do not rely on.
+    template <typename Func>
+    void RunOptional(const char* name, Func&& pass) {
+        if (!IsDisabled(name)) {
+            Run(name, pass);
+        }
+    }
+
+    /// Repeats a group of passes until an iteration no longer removes any instruction.
+    template <typename Func>
+    void RunUntilFixpoint(u32 max_iterations, Func&& iteration) {
+        size_t num_insts = CountInstructions();
+        for (u32 i = 0; i < max_iterations; ++i) {
+            iteration();
+            const size_t num_after = CountInstructions();
+            if (num_after >= num_insts) {
+                break;
+            }
+            num_insts = num_after;
+        }
+    }
+
+private:
+    [[nodiscard]] size_t CountInstructions() const;
+    [[nodiscard]] static bool IsDisabled(std::string_view name);
+    void Record(std::string_view name, std::chrono::nanoseconds time, s64 removed_insts);
+
+    const IR::Program& program;
+    TranslationStats* stats;
+    bool count_insts;
+    std::chrono::steady_clock::time_point start;
+};
+
+} // namespace Shader::Optimization
@@ -0,0 +1,205 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <array>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "common/hash.h"
+#include "shader_recompiler/ir/program.h"
+
+namespace Shader::Optimization {
+
+namespace {
+
+// Numbers pure instructions by opcode, flags and operands, like the SRT table used by userdata
+// flattening, but for every pure instruction and scoped by dominance so it can replace them.
+struct InstKey {
+    IR::Opcode opcode;
+    u32 flags;
+    std::array<IR::Value, 6> args;
+
+    bool operator==(const InstKey&) const = default;
+};
+
+struct HashInstKey {
+    size_t operator()(const InstKey& key) const {
+        u64 h = HashCombine(static_cast<u64>(key.opcode), static_cast<u64>(key.flags));
+        for (const IR::Value& arg : key.args) {
+            h = HashCombine(h, static_cast<u64>(std::hash<IR::Value>{}(arg)));
+        }
+        return h;
+    }
+};
+
+bool IsCommutative(IR::Opcode opcode) {
+    switch (opcode) {
+    case IR::Opcode::FPAdd32:
+    case IR::Opcode::FPAdd64:
+    case IR::Opcode::FPMul32:
+    case IR::Opcode::FPMul64:
+    case IR::Opcode::IAdd32:
+    case IR::Opcode::IAdd64:
+    case IR::Opcode::IMul32:
+    case IR::Opcode::IMul64:
+    case IR::Opcode::BitwiseAnd32:
+    case IR::Opcode::BitwiseAnd64:
+    case IR::Opcode::BitwiseOr32:
+    case IR::Opcode::BitwiseOr64:
+    case IR::Opcode::BitwiseXor32:
+    case IR::Opcode::SMin32:
+    case IR::Opcode::UMin32:
+    case IR::Opcode::SMax32:
+    case IR::Opcode::UMax32:
+    case IR::Opcode::IEqual:
+    case IR::Opcode::INotEqual:
+    case IR::Opcode::LogicalOr:
+    case IR::Opcode::LogicalAnd:
+    case IR::Opcode::LogicalXor:
+        return true;
+    default:
+        return false;
+    }
+}
+
+InstKey MakeKey(const IR::Inst& inst) {
+    InstKey key{
+        .opcode = inst.GetOpcode(),
+        .flags = inst.Flags<u32>(),
+        .args = {},
+    };
+    for (size_t i = 0; i < inst.NumArgs(); ++i) {
+        key.args[i] = inst.Arg(i);
+    }
+    // Order the operands of commutative operations so that a + b and b + a get the same key.
+    if (IsCommutative(key.opcode)) {
+        const std::hash<IR::Value> hash;
+        if (hash(key.args[1]) < hash(key.args[0])) {
+            std::swap(key.args[0], key.args[1]);
+        }
+    }
+    return key;
+}
+
+/// Immediate dominator of each block, indexed by post order. Uses the algorithm from "A Simple,
+/// Fast Dominance Algorithm" by Cooper, Harvey and Kennedy.
+std::vector<size_t> ComputeDominators(const IR::BlockList& post_order,
+                                      const std::unordered_map<const IR::Block*, size_t>& index) {
+    constexpr size_t Undefined = ~size_t{0};
+    const size_t entry = post_order.size() - 1;
+    std::vector<size_t> idom(post_order.size(), Undefined);
+    idom[entry] = entry;
+
+    const auto intersect = [&](size_t a, size_t b) {
+        while (a != b) {
+            while (a < b) {
+                a = idom[a];
+            }
+            while (b < a) {
+                b = idom[b];
+            }
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = entry; i-- > 0;) {
+            size_t new_idom = Undefined;
+            for (const IR::Block* pred : post_order[i]->ImmPredecessors()) {
+                const auto it = index.find(pred);
+                if (it == index.end() || idom[it->second] == Undefined) {
+                    continue;
+                }
+                new_idom = new_idom == Undefined ? it->second : intersect(it->second, new_idom);
+            }
+            if (idom[i] != new_idom) {
+                idom[i] = new_idom;
+                changed = true;
+            }
+        }
+    }
+    return idom;
+}
+
+} // Anonymous namespace
+
+void ValueNumberingPass(IR::Program& program) {
+    const IR::BlockList& post_order = program.post_order_blocks;
+    if (post_order.empty()) {
+        return;
+    }
+    std::unordered_map<const IR::Block*, size_t> index;
+    for (size_t i = 0; i < post_order.size(); ++i) {
+        index.emplace(post_order[i], i);
+    }
+    const std::vector<size_t> idom = ComputeDominators(post_order, index);
+    std::vector<std::vector<size_t>> children(post_order.size());
+    for (size_t i = 0; i + 1 < post_order.size(); ++i) {
+        children[idom[i]].push_back(i);
+    }
+
+    // Walk the dominator tree, so that an instruction is only replaced by an equal one that
+    // dominates it. Keys added in a subtree are dropped when the walk leaves it.
+    std::unordered_map<InstKey, IR::Inst*, HashInstKey> available;
+    std::vector<InstKey> scope_keys;
+    std::vector<std::pair<IR::Block*, IR::Inst*>> replaced;
+    struct Visit {
+        size_t block;
+        size_t next_child;
+        size_t scope_begin;
+    };
+    std::vector<Visit> stack;
+    stack.push_back({post_order.size() - 1, 0, 0});
+    while (!stack.empty()) {
+        Visit& visit = stack.back();
+        IR::Block* const block = post_order[visit.block];
+        if (visit.next_child == 0) {
+            visit.scope_begin = scope_keys.size();
+            for (IR::Inst& inst : *block) {
+                if (inst.GetOpcode() == IR::Opcode::Phi) {
+                    continue;
+                }
+                // Operands may refer to instructions replaced earlier in a dominating block.
+                for (size_t i = 0; i < inst.NumArgs(); ++i) {
+                    IR::Value arg;
+                    while ((arg = inst.Arg(i)).IsIdentity()) {
+                        inst.SetArg(i, arg.Inst()->Arg(0));
+                    }
+                }
+                if (!inst.IsPure()) {
+                    continue;
+                }
+                InstKey key = MakeKey(inst);
+                const auto [it, is_new] = available.try_emplace(key, &inst);
+                if (is_new) {
+                    scope_keys.push_back(std::move(key));
+                } else {
+                    inst.ReplaceUsesWith(IR::Value{it->second});
+                    replaced.emplace_back(block, &inst);
+                }
+            }
+        }
+        if (visit.next_child < children[visit.block].size()) {
+            const size_t child = children[visit.block][visit.next_child++];
+            stack.push_back({child, 0, 0});
+            continue;
+        }
+        while (scope_keys.size() > visit.scope_begin) {
+            available.erase(scope_keys.back());
+            scope_keys.pop_back();
+        }
+        stack.pop_back();
+    }
+
+    // Phis on back edges can still refer to a replaced instruction, identity removal drops those.
+    for (const auto& [block, inst] : replaced) {
+        if (!inst->HasUses()) {
+            block->Instructions().erase(block->Instructions().iterator_to(*inst));
+            inst->Invalidate();
+        }
+    }
+}
+
+} // namespace Shader::Optimization
@@ -8,10 +8,10 @@
 
 namespace Shader::IR {
 
-BlockList PostOrder(const AbstractSyntaxNode& root) {
+BlockList PostOrder(const AbstractSyntaxNode& root, std::pmr::memory_resource* resource) {
     boost::container::small_vector<Block*, 16> block_stack;
     boost::container::flat_set<Block*> visited;
-    BlockList post_order_blocks;
+    BlockList post_order_blocks{resource};
 
     if (root.type != AbstractSyntaxNode::Type::Block) {
         UNREACHABLE_MSG("First node in abstract syntax list root is not a block");
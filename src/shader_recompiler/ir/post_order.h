@@ -8,6 +8,7 @@
 
 namespace Shader::IR {
 
-BlockList PostOrder(const AbstractSyntaxNode& root);
+BlockList PostOrder(const AbstractSyntaxNode& root,
+                    std::pmr::memory_resource* resource = std::pmr::get_default_resource());
 
 } // namespace Shader::IR
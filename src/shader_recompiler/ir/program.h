@@ -12,12 +12,15 @@
 namespace Shader::IR {
 
 struct Program {
-    explicit Program(Info& info_) : info{info_} {}
+    explicit Program(Info& info_,
+                     std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : syntax_list{resource}, blocks{resource}, post_order_blocks{resource},
+          ins_list{resource}, info{info_} {}
 
     AbstractSyntaxList syntax_list;
     BlockList blocks;
     BlockList post_order_blocks;
-    std::vector<Gcn::GcnInst> ins_list;
+    std::pmr::vector<Gcn::GcnInst> ins_list;
     Info& info;
 };
 
@@ -136,6 +136,10 @@ public:
     /// Determines whether or not this instruction may have side effects.
     [[nodiscard]] bool MayHaveSideEffects() const noexcept;
 
+    /// Determines whether the result only depends on the arguments, so that equal instructions
+    /// can be merged and the instruction can be moved to any block its arguments dominate.
+    [[nodiscard]] bool IsPure() const noexcept;
+
     /// Determines if all arguments of this instruction are immediates.
     [[nodiscard]] bool AreAllArgsImmediates() const;
 
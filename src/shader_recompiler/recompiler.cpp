@@ -5,6 +5,7 @@
 #include "shader_recompiler/frontend/decode.h"
 #include "shader_recompiler/frontend/structured_control_flow.h"
 #include "shader_recompiler/ir/passes/ir_passes.h"
+#include "shader_recompiler/ir/passes/pass_manager.h"
 #include "shader_recompiler/ir/post_order.h"
 #include "shader_recompiler/recompiler.h"
 
@@ -17,7 +18,7 @@ IR::BlockList GenerateBlocks(const IR::AbstractSyntaxList& syntax_list) {
             ++num_syntax_blocks;
         }
     }
-    IR::BlockList blocks;
+    IR::BlockList blocks{syntax_list.get_allocator()};
     blocks.reserve(num_syntax_blocks);
     u32 order_index{};
     for (const auto& node : syntax_list) {
@@ -29,7 +30,8 @@ IR::BlockList GenerateBlocks(const IR::AbstractSyntaxList& syntax_list) {
 }
 
 IR::Program TranslateProgram(std::span<const u32> code, Pools& pools, Info& info,
-                             const RuntimeInfo& runtime_info, const Profile& profile) {
+                             const RuntimeInfo& runtime_info, const Profile& profile,
+                             TranslationStats* stats) {
     // Ensure first instruction is expected.
     constexpr u32 token_mov_vcchi = 0xBEEB03FF;
     if (code[0] != token_mov_vcchi) {
@@ -39,38 +41,59 @@ IR::Program TranslateProgram(std::span<const u32> code, Pools& pools, Info& info
     Gcn::GcnCodeSlice slice(code.data(), code.data() + code.size());
     Gcn::GcnDecodeContext decoder;
 
+    // Clear any previous pooled data.
+    pools.ReleaseContents();
+
     // Decode and save instructions
-    IR::Program program{info};
+    IR::Program program{info, &pools.arena};
+    Shader::Optimization::PassManager passes{program, stats};
     program.ins_list.reserve(code.size());
     while (!slice.atEnd()) {
         program.ins_list.emplace_back(decoder.decodeInstruction(slice));
     }
-
-    // Clear any previous pooled data.
-    pools.ReleaseContents();
+    passes.Lap("Decode");
 
     // Create control flow graph
-    Common::ObjectPool<Gcn::Block> gcn_block_pool{64};
-    Gcn::CFG cfg{gcn_block_pool, program.ins_list};
+    Gcn::CFG cfg{pools.gcn_block_pool, program.ins_list, &pools.arena};
+    passes.Lap("CFG");
 
     // Structurize control flow graph and create program.
     program.syntax_list = Shader::Gcn::BuildASL(pools.inst_pool, pools.block_pool, cfg,
-                                                program.info, runtime_info, profile);
+                                                program.info, runtime_info, profile, &pools.arena);
     program.blocks = GenerateBlocks(program.syntax_list);
-    program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front());
+    program.post_order_blocks = Shader::IR::PostOrder(program.syntax_list.front(), &pools.arena);
+    passes.Lap("BuildASL");
 
     // Run optimization passes
-    Shader::Optimization::SsaRewritePass(program.post_order_blocks);
-    Shader::Optimization::ConstantPropagationPass(program.post_order_blocks);
+    using namespace Shader::Optimization;
+    passes.Run("SsaRewrite", [&] { SsaRewritePass(program.post_order_blocks); });
+    // Resource tracking needs the folded s_getpc based address of inline constant buffers.
+    passes.Run("ConstantPropagation", [&] { ConstantPropagationPass(program.post_order_blocks); });
     if (program.info.stage != Stage::Compute) {
-        Shader::Optimization::LowerSharedMemToRegisters(program);
+        passes.Run("LowerSharedMemToRegisters", [&] { LowerSharedMemToRegisters(program); });
+    }
+    passes.Run("RingAccessElimination",
+               [&] { RingAccessElimination(program, runtime_info, program.info.stage); });
+    passes.Run("FlattenExtendedUserdata", [&] { FlattenExtendedUserdataPass(program); });
+    passes.Run("ResourceTracking", [&] { ResourceTrackingPass(program); });
+
+    // Resource tracking leaves address arithmetic that folds once sharps are resolved, and every
+    // fold can make more instructions redundant or dead.
+    passes.RunOptional("LoopInvariantCodeMotion", [&] { LoopInvariantCodeMotionPass(program); });
+    constexpr u32 MaxCleanupIterations = 4;
+    passes.RunUntilFixpoint(MaxCleanupIterations, [&] {
+        passes.RunOptional("IdentityRemoval", [&] { IdentityRemovalPass(program.blocks); });
+        passes.RunOptional("ValueNumbering", [&] { ValueNumberingPass(program); });
+        passes.RunOptional("DeadCodeElimination", [&] { DeadCodeEliminationPass(program); });
+        passes.RunOptional("ConstantPropagation",
+                           [&] { ConstantPropagationPass(program.post_order_blocks); });
+    });
+    passes.RunOptional("IdentityRemoval", [&] { IdentityRemovalPass(program.blocks); });
+    passes.Run("CollectShaderInfo", [&] { CollectShaderInfoPass(program); });
+
+    if (stats) {
+        stats->arena = pools.arena.GetStats();
     }
-    Shader::Optimization::RingAccessElimination(program, runtime_info, program.info.stage);
-    Shader::Optimization::FlattenExtendedUserdataPass(program);
-    Shader::Optimization::ResourceTrackingPass(program);
-    Shader::Optimization::IdentityRemovalPass(program.blocks);
-    Shader::Optimization::DeadCodeEliminationPass(program);
-    Shader::Optimization::CollectShaderInfoPass(program);
 
     return program;
 }
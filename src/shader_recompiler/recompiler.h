@@ -3,7 +3,12 @@
 
 #pragma once
 
+#include <chrono>
+#include <string_view>
+#include <vector>
+#include "common/arena.h"
 #include "common/object_pool.h"
+#include "shader_recompiler/frontend/control_flow_graph.h"
 #include "shader_recompiler/ir/basic_block.h"
 #include "shader_recompiler/ir/program.h"
 
@@ -12,22 +17,48 @@ namespace Shader {
 struct Profile;
 struct RuntimeInfo;
 
+/// Revision of the recompiler output. Bump whenever the emitted SPIR-V changes for the same
+/// input program, so that persistent shader caches produced by older revisions are discarded.
+constexpr u32 RecompilerVersion = 3;
+
+/// Storage of a translation that lives until the next one. Every compiling thread needs its own.
 struct Pools {
     static constexpr u32 InstPoolSize = 8192;
     static constexpr u32 BlockPoolSize = 32;
+    static constexpr u32 GcnBlockPoolSize = 64;
 
     Common::ObjectPool<IR::Inst> inst_pool;
     Common::ObjectPool<IR::Block> block_pool;
+    Common::ObjectPool<Gcn::Block> gcn_block_pool;
+    /// Backs the decoded instructions, CFG and syntax and block lists of the program.
+    Common::MonotonicArena arena;
 
-    explicit Pools() : inst_pool{InstPoolSize}, block_pool{BlockPoolSize} {}
+    explicit Pools()
+        : inst_pool{InstPoolSize}, block_pool{BlockPoolSize}, gcn_block_pool{GcnBlockPoolSize} {}
 
     void ReleaseContents() {
         inst_pool.ReleaseContents();
         block_pool.ReleaseContents();
+        gcn_block_pool.ReleaseContents();
+        arena.Reset();
     }
 };
 
+struct PassStats {
+    std::string_view name;
+    std::chrono::nanoseconds time{};
+    s64 removed_insts{}; ///< Negative when the pass added instructions.
+};
+
+/// Stages of a translation in the order they ran. Passes repeated until a fixpoint appear once
+/// per run.
+struct TranslationStats {
+    std::vector<PassStats> passes;
+    Common::MonotonicArena::Stats arena;
+};
+
 [[nodiscard]] IR::Program TranslateProgram(std::span<const u32> code, Pools& pools, Info& info,
-                                           const RuntimeInfo& runtime_info, const Profile& profile);
+                                           const RuntimeInfo& runtime_info, const Profile& profile,
+                                           TranslationStats* stats = nullptr);
 
 } // namespace Shader
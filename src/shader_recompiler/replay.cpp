@@ -0,0 +1,284 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <array>
+#include <exception>
+#include <thread>
+#include <fmt/core.h>
+#include <xxhash.h>
+
+#include "common/io_file.h"
+#include "common/thread_worker.h"
+#include "shader_recompiler/backend/bindings.h"
+#include "shader_recompiler/backend/spirv/emit_spirv.h"
+#include "shader_recompiler/frontend/decode.h"
+#include "shader_recompiler/info.h"
+#include "shader_recompiler/params.h"
+#include "shader_recompiler/profile.h"
+#include "shader_recompiler/recompiler.h"
+#include "shader_recompiler/replay.h"
+#include "shader_recompiler/runtime_info.h"
+
+namespace Shader {
+
+constexpr u32 ContextMagic = 0x58435253; // "SRCX"
+constexpr u32 ContextVersion = 1;
+
+/// Fixed part of a translation context file. It is followed by the runtime info and profile as
+/// raw bytes, the flattened user data and the code of the geometry copy shader.
+struct ContextHeader {
+    u32 magic;
+    u32 version;
+    Stage stage;
+    u32 has_fetch_shader;
+    u64 pgm_hash;
+    Backend::Bindings binding;
+    u32 num_flat_ud;
+    u32 num_vs_copy;
+    std::array<u32, ShaderParams::NumShaderUserData> user_data;
+};
+
+void DumpTranslationContext(const std::filesystem::path& path, const Info& info,
+                            const RuntimeInfo& runtime_info, const Profile& profile,
+                            const Backend::Bindings& binding) {
+    ContextHeader header{
+        .magic = ContextMagic,
+        .version = ContextVersion,
+        .stage = info.stage,
+        .has_fetch_shader = info.has_fetch_shader,
+        .pgm_hash = info.pgm_hash,
+        .binding = binding,
+        .num_flat_ud = static_cast<u32>(info.flattened_ud_buf.size()),
+        .num_vs_copy = 0,
+        .user_data = {},
+    };
+    std::span<const u32> vs_copy;
+    if (runtime_info.stage == Stage::Geometry) {
+        vs_copy = runtime_info.gs_info.vs_copy;
+        header.num_vs_copy = static_cast<u32>(vs_copy.size());
+    }
+    std::copy_n(info.user_data.begin(), std::min(info.user_data.size(), header.user_data.size()),
+                header.user_data.begin());
+
+    const Common::FS::IOFile file{path, Common::FS::FileAccessMode::Write};
+    file.WriteObject(header);
+    file.WriteObject(runtime_info);
+    file.WriteObject(profile);
+    file.WriteSpan(std::span<const u32>{info.flattened_ud_buf});
+    file.WriteSpan(vs_copy);
+}
+
+namespace {
+
+enum class ReplayStatus {
+    Compiled,
+    Skipped,
+    Failed,
+};
+
+struct ReplayResult {
+    std::string name;
+    ReplayStatus status{};
+    std::string message;
+    TranslationStats stats;
+    std::chrono::nanoseconds emit_time{};
+    size_t spirv_size{};
+    u64 spirv_hash{};
+    std::vector<u32> code;
+};
+
+ReplayResult ReplayShader(const std::filesystem::path& context_path) {
+    ReplayResult result{.name = context_path.stem().string()};
+    const auto fail = [&](std::string_view message) {
+        result.status = ReplayStatus::Failed;
+        result.message = message;
+        return std::move(result);
+    };
+
+    const Common::FS::IOFile file{context_path, Common::FS::FileAccessMode::Read};
+    ContextHeader header;
+    RuntimeInfo runtime_info{Stage::Compute};
+    Profile profile;
+    if (!file.ReadObject(header) || header.magic != ContextMagic ||
+        header.version != ContextVersion || !file.ReadObject(runtime_info) ||
+        !file.ReadObject(profile)) {
+        return fail("invalid context file");
+    }
+    std::vector<u32> flat_ud(header.num_flat_ud);
+    std::vector<u32> vs_copy(header.num_vs_copy);
+    if (file.ReadSpan(std::span{flat_ud}) != flat_ud.size() ||
+        file.ReadSpan(std::span{vs_copy}) != vs_copy.size()) {
+        return fail("truncated context file");
+    }
+    if (header.has_fetch_shader) {
+        // Vertex attributes are described by guest memory that is not part of the dump.
+        result.status = ReplayStatus::Skipped;
+        result.message = "uses a fetch shader";
+        return result;
+    }
+    if (header.stage == Stage::Geometry) {
+        runtime_info.gs_info.vs_copy = vs_copy;
+    }
+
+    auto code_path = context_path;
+    const Common::FS::IOFile code_file{code_path.replace_extension(".bin"),
+                                       Common::FS::FileAccessMode::Read};
+    std::vector<u32> code(code_file.IsOpen() ? code_file.GetSize() / sizeof(u32) : 0);
+    if (code.empty() || code_file.ReadSpan(std::span{code}) != code.size()) {
+        return fail("missing shader binary");
+    }
+
+    // Pools are reused between the shaders a worker compiles, like in the pipeline cache.
+    thread_local Pools pools;
+    const ShaderParams params{
+        .user_data = header.user_data,
+        .code = code,
+        .hash = header.pgm_hash,
+    };
+    Info info{header.stage, params};
+    info.replay_ud_buf = flat_ud;
+    try {
+        const auto program =
+            TranslateProgram(code, pools, info, runtime_info, profile, &result.stats);
+        auto binding = header.binding;
+        const auto emit_start = std::chrono::steady_clock::now();
+        const auto spirv = Backend::SPIRV::EmitSPIRV(profile, runtime_info, program, binding);
+        result.emit_time = std::chrono::steady_clock::now() - emit_start;
+        result.spirv_size = spirv.size() * sizeof(u32);
+        result.spirv_hash = XXH3_64bits(spirv.data(), result.spirv_size);
+    } catch (const std::exception& e) {
+        return fail(e.what());
+    }
+    result.status = ReplayStatus::Compiled;
+    result.code = std::move(code);
+    return result;
+}
+
+struct DecodeThroughput {
+    u64 num_insts{};
+    u64 num_bytes{};
+    std::chrono::nanoseconds time{};
+};
+
+/// Decodes the code of every compiled shader on a single thread, repeating the corpus until the
+/// measurement is long enough to be stable. Only shaders that compiled are known to decode.
+DecodeThroughput MeasureDecodeThroughput(const std::vector<ReplayResult>& results) {
+    constexpr auto MinDuration = std::chrono::milliseconds{250};
+    DecodeThroughput throughput{};
+    const auto start = std::chrono::steady_clock::now();
+    do {
+        for (const auto& result : results) {
+            if (result.status != ReplayStatus::Compiled) {
+                continue;
+            }
+            Gcn::GcnCodeSlice slice{result.code.data(), result.code.data() + result.code.size()};
+            Gcn::GcnDecodeContext decoder;
+            while (!slice.atEnd()) {
+                // The instruction length leaves out literal constants, count the words consumed.
+                const u32* const inst_start = slice.position();
+                decoder.decodeInstruction(slice);
+                throughput.num_bytes += (slice.position() - inst_start) * sizeof(u32);
+                ++throughput.num_insts;
+            }
+        }
+        throughput.time = std::chrono::steady_clock::now() - start;
+    } while (throughput.num_insts != 0 && throughput.time < MinDuration);
+    return throughput;
+}
+
+} // Anonymous namespace
+
+bool RecompileShaderDumps(const std::filesystem::path& dump_dir) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> contexts;
+    for (const auto& entry : std::filesystem::directory_iterator{dump_dir, ec}) {
+        if (entry.path().extension() == ".ctx") {
+            contexts.push_back(entry.path());
+        }
+    }
+    if (ec) {
+        fmt::print("Unable to read shader dump directory {}: {}\n", dump_dir.string(),
+                   ec.message());
+        return false;
+    }
+    std::ranges::sort(contexts);
+
+    std::vector<ReplayResult> results(contexts.size());
+    const auto start = std::chrono::steady_clock::now();
+    {
+        const size_t num_workers = std::max(std::thread::hardware_concurrency(), 1U);
+        Common::ThreadWorker workers{num_workers, "shadPS4:ShaderReplay"};
+        for (size_t i = 0; i < contexts.size(); ++i) {
+            workers.QueueWork([&results, &contexts, i] { results[i] = ReplayShader(contexts[i]); });
+        }
+        workers.WaitForRequests();
+    }
+    const auto wall_time = std::chrono::steady_clock::now() - start;
+
+    // Per shader lines are stable between runs, so two reports can be diffed for regressions.
+    std::vector<PassStats> pass_totals;
+    const auto add_pass = [&](const PassStats& pass) {
+        const auto it = std::ranges::find(pass_totals, pass.name, &PassStats::name);
+        if (it == pass_totals.end()) {
+            pass_totals.push_back(pass);
+        } else {
+            it->time += pass.time;
+            it->removed_insts += pass.removed_insts;
+        }
+    };
+    size_t num_compiled = 0;
+    size_t num_skipped = 0;
+    size_t total_spirv_size = 0;
+    Common::MonotonicArena::Stats arena{};
+    for (const auto& result : results) {
+        switch (result.status) {
+        case ReplayStatus::Compiled:
+            fmt::print("{} {} bytes {:#018x}\n", result.name, result.spirv_size,
+                       result.spirv_hash);
+            ++num_compiled;
+            total_spirv_size += result.spirv_size;
+            for (const auto& pass : result.stats.passes) {
+                add_pass(pass);
+            }
+            add_pass({.name = "EmitSPIRV", .time = result.emit_time});
+            arena.num_allocations += result.stats.arena.num_allocations;
+            arena.bytes_allocated += result.stats.arena.bytes_allocated;
+            arena.num_chunk_allocations += result.stats.arena.num_chunk_allocations;
+            break;
+        case ReplayStatus::Skipped:
+            fmt::print("{} skipped: {}\n", result.name, result.message);
+            ++num_skipped;
+            break;
+        case ReplayStatus::Failed:
+            fmt::print("{} failed: {}\n", result.name, result.message);
+            break;
+        }
+    }
+
+    const auto to_ms = [](auto time) {
+        return std::chrono::duration<double, std::milli>(time).count();
+    };
+    const size_t num_failed = results.size() - num_compiled - num_skipped;
+    fmt::print("\n{} compiled, {} skipped, {} failed in {:.1f} ms, {} bytes of SPIR-V\n",
+               num_compiled, num_skipped, num_failed, to_ms(wall_time), total_spirv_size);
+    // Without the arena, every allocation it served would have gone to the heap.
+    fmt::print("{} transient allocations ({} bytes) served by {} heap allocations\n",
+               arena.num_allocations, arena.bytes_allocated, arena.num_chunk_allocations);
+    for (const auto& pass : pass_totals) {
+        fmt::print("  {:<28} {:>10.2f} ms total {:>10.1f} us mean {:>10} insts removed\n",
+                   pass.name, to_ms(pass.time),
+                   to_ms(pass.time) * 1000.0 / std::max<size_t>(num_compiled, 1),
+                   pass.removed_insts);
+    }
+
+    const auto decode = MeasureDecodeThroughput(results);
+    if (decode.num_insts != 0) {
+        const double seconds = std::chrono::duration<double>(decode.time).count();
+        fmt::print("Decode throughput: {:.1f} M instructions/s, {:.1f} MB/s\n",
+                   decode.num_insts / seconds / 1e6, decode.num_bytes / seconds / 1e6);
+    }
+    return num_failed == 0;
+}
+
+} // namespace Shader
@@ -0,0 +1,32 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <filesystem>
+
+namespace Shader {
+
+struct Info;
+struct Profile;
+struct RuntimeInfo;
+
+namespace Backend {
+struct Bindings;
+}
+
+/**
+ * Writes the inputs of a shader compilation next to the dumped shader binary, so that the
+ * shader can be recompiled without the game. Must be called after translation, as it also
+ * captures the flattened user data read from guest memory.
+ */
+void DumpTranslationContext(const std::filesystem::path& path, const Info& info,
+                            const RuntimeInfo& runtime_info, const Profile& profile,
+                            const Backend::Bindings& binding);
+
+/// Recompiles every shader dump in the directory on all cores and prints the size of the emitted
+/// SPIR-V, the time spent in each pass and the single threaded throughput of the decoder.
+/// Returns false if any shader failed to compile.
+bool RecompileShaderDumps(const std::filesystem::path& dump_dir);
+
+} // namespace Shader
@@ -36,13 +36,55 @@ static std::span<const u32> NextPacket(std::span<const u32> span, size_t offset)
     return span.subspan(offset);
 }
 
-Liverpool::Liverpool() {
+// Blocked queues are woken up when another queue writes memory or new work is submitted. Guest
+// CPU writes to the waited memory are not observed, so the wait condition is still re-checked
+// after this long.
+constexpr auto GuestWriteTimeout = std::chrono::milliseconds{1};
+
+Liverpool::Liverpool() : parallel_compute{Config::isParallelComputeEnabled()} {
     process_thread = std::jthread{std::bind_front(&Liverpool::Process, this)};
 }
 
 Liverpool::~Liverpool() {
     process_thread.request_stop();
     process_thread.join();
+    for (auto& queue : mapped_queues) {
+        queue.thread = {};
+    }
+}
+
+void Liverpool::SetRegs(u32 reg_addr, const u32* values, size_t num_values) {
+    // Games commonly re-emit whole register blocks with identical values between draws.
+    u32* regs_data = &regs.reg_array[reg_addr];
+    const size_t size = num_values * sizeof(u32);
+    if (std::memcmp(regs_data, values, size) != 0) {
+        std::memcpy(regs_data, values, size);
+        ++regs_version;
+    }
+}
+
+std::unique_lock<std::mutex> Liverpool::LockRasterizer() {
+    if (!parallel_compute) {
+        return {};
+    }
+    return std::unique_lock{rasterizer_mutex};
+}
+
+void Liverpool::NotifyMemoryWrite() {
+    if (!parallel_compute) {
+        return;
+    }
+    {
+        std::scoped_lock lk{memory_write_mutex};
+        ++memory_write_seq;
+    }
+    memory_write_cv.notify_all();
+}
+
+void Liverpool::WaitMemoryWrite(u64 last_write) {
+    std::unique_lock lk{memory_write_mutex};
+    memory_write_cv.wait_for(lk, GuestWriteTimeout,
+                             [&] { return memory_write_seq != last_write; });
 }
 
 void Liverpool::Process(std::stop_token stoken) {
@@ -74,12 +116,14 @@ void Liverpool::Process(std::stop_token stoken) {
                     command_queue.pop();
                 }
 
+                const auto lk = LockRasterizer();
                 callback();
 
                 --num_commands;
             }
 
-            qid = (qid + 1) % NumTotalQueues;
+            // Compute queues are driven by their own threads in parallel mode.
+            qid = parallel_compute ? GfxQueueId : (qid + 1) % NumTotalQueues;
 
             auto& queue = mapped_queues[qid];
 
@@ -91,6 +135,9 @@ void Liverpool::Process(std::stop_token stoken) {
                 }
                 task = queue.submits.front();
             }
+            // The graphics task locks the rasterizer per packet, letting compute queue threads
+            // dispatch between its packets.
+            const u64 last_write = memory_write_seq;
             task.resume();
 
             if (task.done()) {
@@ -102,6 +149,9 @@ void Liverpool::Process(std::stop_token stoken) {
                 --num_submits;
                 std::scoped_lock lock2{submit_mutex};
                 submit_cv.notify_all();
+            } else if (parallel_compute) {
+                // There is nothing else to switch to, sleep until the wait can be satisfied.
+                WaitMemoryWrite(last_write);
             }
         }
 
@@ -109,6 +159,7 @@ void Liverpool::Process(std::stop_token stoken) {
             VideoCore::EndCapture();
 
             if (rasterizer) {
+                const auto lk = LockRasterizer();
                 rasterizer->Flush();
             }
             submit_done = false;
@@ -118,6 +169,43 @@ void Liverpool::Process(std::stop_token stoken) {
     }
 }
 
+void Liverpool::ProcessComputeQueue(std::stop_token stoken, u32 vqid) {
+    const auto thread_name = fmt::format("shadPS4:GPU_ComputeQueue{}", vqid);
+    Common::SetCurrentThreadName(thread_name.c_str());
+
+    auto& queue = mapped_queues[vqid];
+    while (!stoken.stop_requested()) {
+        Task::Handle task{};
+        {
+            std::unique_lock lk{queue.m_access};
+            Common::CondvarWait(queue.submit_cv, lk, stoken,
+                                [&queue] { return !queue.submits.empty(); });
+            if (stoken.stop_requested()) {
+                break;
+            }
+            task = queue.submits.front();
+        }
+
+        const u64 last_write = memory_write_seq;
+        task.resume();
+        if (!task.done()) {
+            // The queue is blocked on a WaitRegMem.
+            WaitMemoryWrite(last_write);
+            continue;
+        }
+
+        task.destroy();
+        {
+            std::scoped_lock lock{queue.m_access};
+            queue.submits.pop();
+        }
+
+        --num_async_submits;
+        std::scoped_lock lk{submit_mutex};
+        submit_cv.notify_all();
+    }
+}
+
 Liverpool::Task Liverpool::ProcessCeUpdate(std::span<const u32> ccb) {
     TracyFiberEnter(ccb_task_name);
 
@@ -191,6 +279,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
 
     const auto base_addr = reinterpret_cast<uintptr_t>(dcb.data());
     while (!dcb.empty()) {
+        auto rasterizer_lock = LockRasterizer();
         const auto* header = reinterpret_cast<const PM4Header*>(dcb.data());
         const u32 type = header->type;
 
@@ -256,13 +345,14 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::ClearState: {
                 regs.SetDefaults();
+                ++regs_version;
                 break;
             }
             case PM4ItOpcode::SetConfigReg: {
                 const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
                 const auto reg_addr = ConfigRegWordOffset + set_data->reg_offset;
                 const auto* payload = reinterpret_cast<const u32*>(header + 2);
-                std::memcpy(&regs.reg_array[reg_addr], payload, (count - 1) * sizeof(u32));
+                SetRegs(reg_addr, payload, count - 1);
                 break;
             }
             case PM4ItOpcode::SetContextReg: {
@@ -270,7 +360,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 const auto reg_addr = ContextRegWordOffset + set_data->reg_offset;
                 const auto* payload = reinterpret_cast<const u32*>(header + 2);
 
-                std::memcpy(&regs.reg_array[reg_addr], payload, (count - 1) * sizeof(u32));
+                SetRegs(reg_addr, payload, count - 1);
 
                 // In the case of HW, render target memory has alignment as color block operates on
                 // tiles. There is no information of actual resource extents stored in CB context
@@ -346,8 +436,8 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
             }
             case PM4ItOpcode::SetUconfigReg: {
                 const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
-                std::memcpy(&regs.reg_array[UconfigRegWordOffset + set_data->reg_offset],
-                            header + 2, (count - 1) * sizeof(u32));
+                SetRegs(UconfigRegWordOffset + set_data->reg_offset,
+                        reinterpret_cast<const u32*>(header + 2), count - 1);
                 break;
             }
             case PM4ItOpcode::IndexType: {
@@ -539,6 +629,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                         *event_eos->Address() = value;
                     }
                 }
+                NotifyMemoryWrite();
                 break;
             }
             case PM4ItOpcode::EventWriteEop: {
@@ -549,6 +640,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                         memcpy(address, &data, num_bytes);
                     }
                 });
+                NotifyMemoryWrite();
                 break;
             }
             case PM4ItOpcode::DmaData: {
@@ -592,6 +684,7 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 } else {
                     UNREACHABLE();
                 }
+                NotifyMemoryWrite();
                 break;
             }
             case PM4ItOpcode::AcquireMem: {
@@ -606,14 +699,17 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
                 // there are no other submits to yield to we can sleep the thread
                 // instead and allow other tasks to run.
                 const u64* wait_addr = wait_reg_mem->Address<u64*>();
-                if (vo_port->IsVoLabel(wait_addr) && num_submits == 1) {
+                if (vo_port->IsVoLabel(wait_addr) && num_submits == 1 && !parallel_compute) {
                     vo_port->WaitVoLabel([&] { return wait_reg_mem->Test(); });
                 }
                 while (!wait_reg_mem->Test()) {
                     mapped_queues[GfxQueueId].cs_state = regs.cs_program;
+                    // Compute queues may be the ones to satisfy the wait.
+                    rasterizer_lock = {};
                     TracyFiberLeave;
                     co_yield {};
                     TracyFiberEnter(dcb_task_name);
+                    rasterizer_lock = LockRasterizer();
                     regs.cs_program = mapped_queues[GfxQueueId].cs_state;
                 }
                 break;
@@ -656,6 +752,8 @@ Liverpool::Task Liverpool::ProcessGraphics(std::span<const u32> dcb, std::span<c
 Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, int vqid) {
     TracyFiberEnter(acb_task_name);
 
+    // Queues running on their own thread keep a private register file like the hardware does.
+    auto& queue_regs = parallel_compute ? *mapped_queues[vqid].compute_regs : regs;
     auto base_addr = reinterpret_cast<uintptr_t>(acb.data());
     while (!acb.empty()) {
         const auto* header = reinterpret_cast<const PM4Header*>(acb.data());
@@ -691,6 +789,7 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, int vqid) {
             if (dma_data->dst_addr_lo == 0x3022C) {
                 break;
             }
+            const auto lk = LockRasterizer();
             if (dma_data->src_sel == DmaDataSrc::Data && dma_data->dst_sel == DmaDataDst::Gds) {
                 rasterizer->InlineData(dma_data->dst_addr_lo, &dma_data->data, sizeof(u32), true);
             } else if (dma_data->src_sel == DmaDataSrc::Memory &&
@@ -720,24 +819,34 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, int vqid) {
         }
         case PM4ItOpcode::SetShReg: {
             const auto* set_data = reinterpret_cast<const PM4CmdSetData*>(header);
-            std::memcpy(&regs.reg_array[ShRegWordOffset + set_data->reg_offset], header + 2,
+            std::memcpy(&queue_regs.reg_array[ShRegWordOffset + set_data->reg_offset], header + 2,
                         (count - 1) * sizeof(u32));
             break;
         }
         case PM4ItOpcode::DispatchDirect: {
             const auto* dispatch_direct = reinterpret_cast<const PM4CmdDispatchDirect*>(header);
-            regs.cs_program.dim_x = dispatch_direct->dim_x;
-            regs.cs_program.dim_y = dispatch_direct->dim_y;
-            regs.cs_program.dim_z = dispatch_direct->dim_z;
-            regs.cs_program.dispatch_initiator = dispatch_direct->dispatch_initiator;
+            auto& cs_program = queue_regs.cs_program;
+            cs_program.dim_x = dispatch_direct->dim_x;
+            cs_program.dim_y = dispatch_direct->dim_y;
+            cs_program.dim_z = dispatch_direct->dim_z;
+            cs_program.dispatch_initiator = dispatch_direct->dispatch_initiator;
+            const auto lk = LockRasterizer();
             if (DebugState.DumpingCurrentReg()) {
-                DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), regs, true);
+                DebugState.PushRegsDump(base_addr, reinterpret_cast<uintptr_t>(header), queue_regs,
+                                        true);
             }
-            if (rasterizer && (regs.cs_program.dispatch_initiator & 1)) {
+            if (rasterizer && (cs_program.dispatch_initiator & 1)) {
+                // The rasterizer reads the compute state from the shared register file.
+                if (parallel_compute) {
+                    std::swap(regs.cs_program, cs_program);
+                }
                 const auto cmd_address = reinterpret_cast<const void*>(header);
                 rasterizer->ScopeMarkerBegin(fmt::format("acb[{}]:{}:Dispatch", vqid, cmd_address));
                 rasterizer->DispatchDirect();
                 rasterizer->ScopeMarkerEnd();
+                if (parallel_compute) {
+                    std::swap(regs.cs_program, cs_program);
+                }
             }
             break;
         }
@@ -750,23 +859,25 @@ Liverpool::Task Liverpool::ProcessCompute(std::span<const u32> acb, int vqid) {
             } else {
                 UNREACHABLE();
             }
+            NotifyMemoryWrite();
             break;
         }
         case PM4ItOpcode::WaitRegMem: {
             const auto* wait_reg_mem = reinterpret_cast<const PM4CmdWaitRegMem*>(header);
             ASSERT(wait_reg_mem->engine.Value() == PM4CmdWaitRegMem::Engine::Me);
             while (!wait_reg_mem->Test()) {
-                mapped_queues[vqid].cs_state = regs.cs_program;
+                mapped_queues[vqid].cs_state = queue_regs.cs_program;
                 TracyFiberLeave;
                 co_yield {};
                 TracyFiberEnter(acb_task_name);
-                regs.cs_program = mapped_queues[vqid].cs_state;
+                queue_regs.cs_program = mapped_queues[vqid].cs_state;
             }
             break;
         }
         case PM4ItOpcode::ReleaseMem: {
             const auto* release_mem = reinterpret_cast<const PM4CmdReleaseMem*>(header);
             release_mem->SignalFence(Platform::InterruptId::Compute0RelMem); // <---
+            NotifyMemoryWrite();
             break;
         }
         default:
@@ -829,15 +940,36 @@ void Liverpool::SubmitGfx(std::span<const u32> dcb, std::span<const u32> ccb) {
         queue.submits.emplace(task.handle);
     }
 
-    std::scoped_lock lk{submit_mutex};
-    ++num_submits;
-    submit_cv.notify_one();
+    {
+        std::scoped_lock lk{submit_mutex};
+        ++num_submits;
+        submit_cv.notify_one();
+    }
+    // The guest usually writes the memory a blocked queue waits on before submitting more work.
+    NotifyMemoryWrite();
 }
 
 void Liverpool::SubmitAsc(u32 vqid, std::span<const u32> acb) {
     ASSERT_MSG(vqid >= 0 && vqid < NumTotalQueues, "Invalid virtual ASC queue index");
     auto& queue = mapped_queues[vqid];
 
+    if (parallel_compute) {
+        {
+            std::scoped_lock lock{queue.m_access};
+            if (!queue.thread.joinable()) {
+                queue.compute_regs = std::make_unique<Regs>();
+                queue.thread = std::jthread{std::bind_front(&Liverpool::ProcessComputeQueue, this),
+                                            vqid};
+            }
+            // Counted before the task becomes visible so the queue thread never underflows it.
+            ++num_async_submits;
+            queue.submits.emplace(ProcessCompute(acb, vqid).handle);
+        }
+        queue.submit_cv.notify_one();
+        NotifyMemoryWrite();
+        return;
+    }
+
     const auto& task = ProcessCompute(acb, vqid);
     {
         std::scoped_lock lock{queue.m_access};
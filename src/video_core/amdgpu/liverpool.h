@@ -7,6 +7,7 @@
 #include <condition_variable>
 #include <coroutine>
 #include <exception>
+#include <memory>
 #include <mutex>
 #include <span>
 #include <thread>
@@ -1229,6 +1230,11 @@ struct Liverpool {
     std::array<CbDbExtent, NumColorBuffers> last_cb_extent{};
     CbDbExtent last_db_extent{};
 
+    /// Incremented whenever a packet changes the value of a config, context or uconfig register.
+    /// Persistent shader registers are not tracked. Consumers compare it against the value they
+    /// last saw to skip rebuilding state derived from unchanged registers.
+    u64 regs_version{};
+
 public:
     Liverpool();
     ~Liverpool();
@@ -1246,11 +1252,11 @@ public:
 
     void WaitGpuIdle() noexcept {
         std::unique_lock lk{submit_mutex};
-        submit_cv.wait(lk, [this] { return num_submits == 0; });
+        submit_cv.wait(lk, [this] { return num_submits == 0 && num_async_submits == 0; });
     }
 
     bool IsGpuIdle() const {
-        return num_submits == 0;
+        return num_submits == 0 && num_async_submits == 0;
     }
 
     void SetVoPort(Libraries::VideoOut::VideoOutPort* port) {
@@ -1262,12 +1268,19 @@ public:
     }
 
     void SendCommand(Common::UniqueFunction<void>&& func) {
-        std::scoped_lock lk{submit_mutex};
-        command_queue.emplace(std::move(func));
-        ++num_commands;
-        submit_cv.notify_one();
+        {
+            std::scoped_lock lk{submit_mutex};
+            command_queue.emplace(std::move(func));
+            ++num_commands;
+            submit_cv.notify_one();
+        }
+        // Commands are run by the command processor, which may be blocked on a WaitRegMem.
+        NotifyMemoryWrite();
     }
 
+    /// Wakes up queues blocked on a WaitRegMem after memory they may wait on was written.
+    void NotifyMemoryWrite();
+
     void reserveCopyBufferSpace() {
         GpuQueue& gfx_queue = mapped_queues[GfxQueueId];
         std::scoped_lock<std::mutex> lk(gfx_queue.m_access);
@@ -1317,6 +1330,18 @@ private:
     Task ProcessCompute(std::span<const u32> acb, int vqid);
 
     void Process(std::stop_token stoken);
+    void ProcessComputeQueue(std::stop_token stoken, u32 vqid);
+
+    /// Writes a range of registers, bumping regs_version if any of them changed.
+    void SetRegs(u32 reg_addr, const u32* values, size_t num_values);
+
+    /// Serializes rasterizer access between the command processor and the compute queue
+    /// threads. Does nothing when compute queues are processed on the command processor.
+    [[nodiscard]] std::unique_lock<std::mutex> LockRasterizer();
+
+    /// Blocks until another queue writes to memory, new work is submitted or a timeout for guest
+    /// CPU writes expires.
+    void WaitMemoryWrite(u64 last_write);
 
     struct GpuQueue {
         std::mutex m_access{};
@@ -1327,6 +1352,10 @@ private:
         std::queue<Task::Handle> submits{};
         ComputeProgram cs_state{};
         VAddr indirect_args_addr{};
+        // Only used by compute queues that run on their own thread.
+        std::unique_ptr<Regs> compute_regs;
+        std::condition_variable_any submit_cv;
+        std::jthread thread;
     };
     std::array<GpuQueue, NumTotalQueues> mapped_queues{};
 
@@ -1352,11 +1381,17 @@ private:
     Libraries::VideoOut::VideoOutPort* vo_port{};
     std::jthread process_thread{};
     std::atomic<u32> num_submits{};
+    std::atomic<u32> num_async_submits{};
     std::atomic<u32> num_commands{};
     std::atomic<bool> submit_done{};
     std::mutex submit_mutex;
     std::condition_variable_any submit_cv;
     std::queue<Common::UniqueFunction<void>> command_queue{};
+    bool parallel_compute{};
+    std::mutex rasterizer_mutex;
+    std::mutex memory_write_mutex;
+    std::condition_variable memory_write_cv;
+    std::atomic<u64> memory_write_seq{};
 };
 
 static_assert(GFX6_3D_REG_INDEX(ps_program) == 0x2C08);
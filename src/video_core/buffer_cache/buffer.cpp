@@ -1,9 +1,12 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
+#include <chrono>
 #include "common/alignment.h"
 #include "common/assert.h"
 #include "video_core/buffer_cache/buffer.h"
+#include "video_core/gpu_stats.h"
 #include "video_core/renderer_vulkan/liverpool_to_vk.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_platform.h"
@@ -92,11 +95,17 @@ Buffer::Buffer(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                VAddr cpu_addr_, vk::BufferUsageFlags flags, u64 size_bytes_)
     : cpu_addr{cpu_addr_}, size_bytes{size_bytes_}, instance{&instance_}, scheduler{&scheduler_},
       usage{usage_}, buffer{instance->GetDevice(), instance->GetAllocator()} {
-    // Create buffer object.
+    // Create buffer object. Upload buffers are also read by the transfer queue.
+    const std::array queue_family_indices = {instance->GetGraphicsQueueFamilyIndex(),
+                                             instance->GetTransferQueueFamilyIndex()};
+    const bool is_shared = usage == MemoryUsage::Upload && instance->HasTransferQueue();
     const vk::BufferCreateInfo buffer_ci = {
         .size = size_bytes,
         // When maintenance5 is not supported, use all flags since we can't add flags to views.
         .usage = instance->IsMaintenance5Supported() ? flags : AllFlags,
+        .sharingMode = is_shared ? vk::SharingMode::eConcurrent : vk::SharingMode::eExclusive,
+        .queueFamilyIndexCount = is_shared ? static_cast<u32>(queue_family_indices.size()) : 0,
+        .pQueueFamilyIndices = is_shared ? queue_family_indices.data() : nullptr,
     };
     VmaAllocationInfo alloc_info{};
     buffer.Create(buffer_ci, usage, &alloc_info);
@@ -205,12 +214,21 @@ void StreamBuffer::WaitPendingOperations(u64 requested_upper_bound) {
     if (!invalidation_mark) {
         return;
     }
+    const auto start = std::chrono::steady_clock::now();
+    bool waited = false;
     while (requested_upper_bound > wait_bound && wait_cursor < *invalidation_mark) {
         auto& watch = previous_watches[wait_cursor];
         wait_bound = watch.upper_bound;
+        waited |= !scheduler->IsFree(watch.tick);
         scheduler->Wait(watch.tick);
         ++wait_cursor;
     }
+    if (waited && usage == MemoryUsage::Upload) {
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        GpuStats::Instance().Add(
+            Stat::UploadStallUs,
+            std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+    }
 }
 
 } // namespace VideoCore
@@ -143,7 +143,9 @@ public:
     bool is_picked{};
     bool is_coherent{};
     bool is_deleted{};
+    bool is_upload_pending{}; ///< Initial contents are written by the upload batch.
     int stream_score = 0;
+    u64 tick_accessed_last = 0;
     size_t size_bytes = 0;
     std::span<u8> mapped_data;
     const Vulkan::Instance* instance;
@@ -2,15 +2,18 @@
 // SPDX-License-Identifier: GPL-2.0-or-later
 
 #include <algorithm>
+#include <utility>
 #include "common/alignment.h"
 #include "common/scope_exit.h"
 #include "common/types.h"
 #include "shader_recompiler/info.h"
 #include "video_core/amdgpu/liverpool.h"
 #include "video_core/buffer_cache/buffer_cache.h"
+#include "video_core/gpu_stats.h"
 #include "video_core/renderer_vulkan/liverpool_to_vk.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/renderer_vulkan/vk_upload_scheduler.h"
 #include "video_core/texture_cache/texture_cache.h"
 
 namespace VideoCore {
@@ -53,8 +56,9 @@ BufferCache::BufferCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& s
 BufferCache::~BufferCache() = default;
 
 void BufferCache::InvalidateMemory(VAddr device_addr, u64 size) {
-    std::scoped_lock lk{mutex};
-    const bool is_tracked = IsRegionRegistered(device_addr, size);
+    // The memory tracker synchronizes its own state, only the page table is shared with the
+    // GPU thread here.
+    const bool is_tracked = IsRegionBacked(device_addr, size);
     if (!is_tracked) {
         return;
     }
@@ -70,23 +74,7 @@ void BufferCache::InvalidateMemory(VAddr device_addr, u64 size) {
 
 void BufferCache::DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 size) {
     boost::container::small_vector<vk::BufferCopy, 1> copies;
-    u64 total_size_bytes = 0;
-    memory_tracker.ForEachDownloadRange<true>(
-        device_addr, size, [&](u64 device_addr_out, u64 range_size) {
-            const VAddr buffer_addr = buffer.CpuAddr();
-            const auto add_download = [&](VAddr start, VAddr end) {
-                const u64 new_offset = start - buffer_addr;
-                const u64 new_size = end - start;
-                copies.push_back(vk::BufferCopy{
-                    .srcOffset = new_offset,
-                    .dstOffset = total_size_bytes,
-                    .size = new_size,
-                });
-                total_size_bytes += new_size;
-            };
-            gpu_modified_ranges.ForEachInRange(device_addr_out, range_size, add_download);
-            gpu_modified_ranges.Subtract(device_addr_out, range_size);
-        });
+    const u64 total_size_bytes = CollectDownloadCopies(buffer, device_addr, size, copies, 0);
     if (total_size_bytes == 0) {
         return;
     }
@@ -107,22 +95,48 @@ void BufferCache::DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 si
     }
 }
 
+u64 BufferCache::CollectDownloadCopies(Buffer& buffer, VAddr device_addr, u64 size,
+                                       boost::container::small_vector<vk::BufferCopy, 1>& copies,
+                                       u64 dst_offset) {
+    u64 total_size_bytes = 0;
+    memory_tracker.ForEachDownloadRange<true>(
+        device_addr, size, [&](u64 device_addr_out, u64 range_size) {
+            const VAddr buffer_addr = buffer.CpuAddr();
+            const auto add_download = [&](VAddr start, VAddr end) {
+                const u64 new_offset = start - buffer_addr;
+                const u64 new_size = end - start;
+                copies.push_back(vk::BufferCopy{
+                    .srcOffset = new_offset,
+                    .dstOffset = dst_offset + total_size_bytes,
+                    .size = new_size,
+                });
+                total_size_bytes += new_size;
+            };
+            gpu_modified_ranges.ForEachInRange(device_addr_out, range_size, add_download);
+            gpu_modified_ranges.Subtract(device_addr_out, range_size);
+        });
+    return total_size_bytes;
+}
+
 bool BufferCache::BindVertexBuffers(const Shader::Info& vs_info) {
     boost::container::small_vector<vk::VertexInputAttributeDescription2EXT, 16> attributes;
     boost::container::small_vector<vk::VertexInputBindingDescription2EXT, 16> bindings;
     SCOPE_EXIT {
         if (instance.IsVertexInputDynamicState()) {
-            const auto cmdbuf = scheduler.CommandBuffer();
-            cmdbuf.setVertexInputEXT(bindings, attributes);
+            scheduler.RecordState([bindings, attributes](vk::CommandBuffer cmdbuf) {
+                cmdbuf.setVertexInputEXT(bindings, attributes);
+            });
         } else if (bindings.empty()) {
             // Required to call bindVertexBuffers2EXT at least once in the current command buffer
             // with non-null strides without a non-dynamic stride pipeline in between. Thus even
             // when nothing is bound we still need to make a dummy call. Non-null strides in turn
             // requires a count greater than 0.
-            const auto cmdbuf = scheduler.CommandBuffer();
             const std::array null_buffers = {GetBuffer(NULL_BUFFER_ID).buffer.buffer};
-            constexpr std::array null_offsets = {static_cast<vk::DeviceSize>(0)};
-            cmdbuf.bindVertexBuffers2EXT(0, null_buffers, null_offsets, null_offsets, null_offsets);
+            scheduler.RecordState([null_buffers](vk::CommandBuffer cmdbuf) {
+                constexpr std::array null_offsets = {static_cast<vk::DeviceSize>(0)};
+                cmdbuf.bindVertexBuffers2EXT(0, null_buffers, null_offsets, null_offsets,
+                                             null_offsets);
+            });
         }
     };
 
@@ -221,13 +235,17 @@ bool BufferCache::BindVertexBuffers(const Shader::Info& vs_info) {
     }
 
     if (num_buffers > 0) {
-        const auto cmdbuf = scheduler.CommandBuffer();
-        if (instance.IsVertexInputDynamicState()) {
-            cmdbuf.bindVertexBuffers(0, num_buffers, host_buffers.data(), host_offsets.data());
-        } else {
-            cmdbuf.bindVertexBuffers2EXT(0, num_buffers, host_buffers.data(), host_offsets.data(),
-                                         host_sizes.data(), host_strides.data());
-        }
+        scheduler.RecordState([num_buffers, host_buffers, host_offsets, host_sizes, host_strides,
+                               is_dynamic = instance.IsVertexInputDynamicState()](
+                                  vk::CommandBuffer cmdbuf) {
+            if (is_dynamic) {
+                cmdbuf.bindVertexBuffers(0, num_buffers, host_buffers.data(), host_offsets.data());
+            } else {
+                cmdbuf.bindVertexBuffers2EXT(0, num_buffers, host_buffers.data(),
+                                             host_offsets.data(), host_sizes.data(),
+                                             host_strides.data());
+            }
+        });
     }
 
     return has_step_rate;
@@ -246,8 +264,10 @@ u32 BufferCache::BindIndexBuffer(bool& is_indexed, u32 index_offset) {
         stream_buffer.Commit();
 
         // Bind index buffer.
-        const auto cmdbuf = scheduler.CommandBuffer();
-        cmdbuf.bindIndexBuffer(stream_buffer.Handle(), offset, vk::IndexType::eUint16);
+        scheduler.RecordState([buffer = stream_buffer.Handle(),
+                               offset = offset](vk::CommandBuffer cmdbuf) {
+            cmdbuf.bindIndexBuffer(buffer, offset, vk::IndexType::eUint16);
+        });
         return index_size / sizeof(u16);
     }
     if (!is_indexed) {
@@ -265,8 +285,10 @@ u32 BufferCache::BindIndexBuffer(bool& is_indexed, u32 index_offset) {
     // Bind index buffer.
     const u32 index_buffer_size = regs.num_indices * index_size;
     const auto [vk_buffer, offset] = ObtainBuffer(index_address, index_buffer_size, false);
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.bindIndexBuffer(vk_buffer->Handle(), offset, index_type);
+    scheduler.RecordState([buffer = vk_buffer->Handle(), offset = offset,
+                           index_type](vk::CommandBuffer cmdbuf) {
+        cmdbuf.bindIndexBuffer(buffer, offset, index_type);
+    });
     return regs.num_indices;
 }
 
@@ -283,6 +305,8 @@ void BufferCache::InlineData(VAddr address, const void* value, u32 num_bytes, bo
             return &gds_buffer;
         }
         const BufferId buffer_id = FindBuffer(address, num_bytes);
+        // Keep the update ordered after the initial upload of the buffer.
+        slot_buffers[buffer_id].is_upload_pending = false;
         return &slot_buffers[buffer_id];
     }();
     const vk::BufferMemoryBarrier2 buf_barrier = {
@@ -325,6 +349,7 @@ std::pair<Buffer*, u32> BufferCache::ObtainBuffer(VAddr device_addr, u32 size, b
         buffer_id = FindBuffer(device_addr, size);
     }
     Buffer& buffer = slot_buffers[buffer_id];
+    buffer.tick_accessed_last = scheduler.CurrentTick();
     SynchronizeBuffer(buffer, device_addr, size, is_texel_buffer);
     if (is_written) {
         memory_tracker.MarkRegionAsGpuModified(device_addr, size);
@@ -339,6 +364,7 @@ std::pair<Buffer*, u32> BufferCache::ObtainViewBuffer(VAddr gpu_addr, u32 size)
     if (buffer_id) {
         Buffer& buffer = slot_buffers[buffer_id];
         if (buffer.IsInBounds(gpu_addr, size)) {
+            buffer.tick_accessed_last = scheduler.CurrentTick();
             SynchronizeBuffer(buffer, gpu_addr, size, false);
             return {&buffer, buffer.Offset(gpu_addr)};
         }
@@ -391,6 +417,81 @@ BufferId BufferCache::FindBuffer(VAddr device_addr, u32 size) {
     return CreateBuffer(device_addr, size);
 }
 
+u64 BufferCache::EvictBuffers(u64 bytes_to_free, u64 min_age) {
+    const u64 current_tick = scheduler.CurrentTick();
+    std::vector<BufferId> candidates;
+    slot_buffers.ForEach([&](BufferId buffer_id, const Buffer& buffer) {
+        if (buffer_id == NULL_BUFFER_ID || buffer.is_deleted ||
+            current_tick - buffer.tick_accessed_last < min_age) {
+            return;
+        }
+        candidates.push_back(buffer_id);
+    });
+    std::ranges::sort(candidates, {}, [this](BufferId buffer_id) {
+        return slot_buffers[buffer_id].tick_accessed_last;
+    });
+
+    // Guest memory becomes the only copy of the data, so write back what the GPU produced and
+    // make sure a future buffer covering the range uploads it again. The downloads of a batch of
+    // evicted buffers share one staging allocation and a single wait for the GPU.
+    using DownloadCopies = boost::container::small_vector<vk::BufferCopy, 1>;
+    std::vector<std::pair<BufferId, DownloadCopies>> evicted;
+    u64 download_size = 0;
+    const auto evict_batch = [&] {
+        if (download_size != 0) {
+            const auto [staging, offset] = staging_buffer.Map(download_size);
+            staging_buffer.Commit();
+            scheduler.EndRendering();
+            const auto cmdbuf = scheduler.CommandBuffer();
+            for (auto& [buffer_id, copies] : evicted) {
+                if (copies.empty()) {
+                    continue;
+                }
+                for (auto& copy : copies) {
+                    copy.dstOffset += offset;
+                }
+                cmdbuf.copyBuffer(slot_buffers[buffer_id].buffer, staging_buffer.Handle(), copies);
+            }
+            scheduler.Finish();
+            for (const auto& [buffer_id, copies] : evicted) {
+                const VAddr buffer_addr = slot_buffers[buffer_id].CpuAddr();
+                for (const auto& copy : copies) {
+                    std::memcpy(std::bit_cast<u8*>(buffer_addr + copy.srcOffset),
+                                staging + (copy.dstOffset - offset), copy.size);
+                }
+            }
+        }
+        for (const auto& [buffer_id, copies] : evicted) {
+            const Buffer& buffer = slot_buffers[buffer_id];
+            const VAddr device_addr = buffer.CpuAddr();
+            const u64 size = buffer.SizeBytes();
+            DeleteBuffer(buffer_id);
+            memory_tracker.MarkRegionAsCpuModified(device_addr, size);
+        }
+        evicted.clear();
+        download_size = 0;
+    };
+
+    u64 bytes_freed = 0;
+    for (const BufferId buffer_id : candidates) {
+        if (bytes_freed >= bytes_to_free) {
+            break;
+        }
+        Buffer& buffer = slot_buffers[buffer_id];
+        const u64 size = buffer.SizeBytes();
+        if (download_size + size > StagingBufferSize) {
+            evict_batch();
+        }
+        auto& copies = evicted.emplace_back(buffer_id, DownloadCopies{}).second;
+        download_size +=
+            CollectDownloadCopies(buffer, buffer.CpuAddr(), size, copies, download_size);
+        bytes_freed += size;
+    }
+    evict_batch();
+    GpuStats::Instance().Add(Stat::EvictedBufferBytes, bytes_freed);
+    return bytes_freed;
+}
+
 BufferCache::OverlapResult BufferCache::ResolveOverlaps(VAddr device_addr, u32 wanted_size) {
     static constexpr int STREAM_LEAP_THRESHOLD = 16;
     boost::container::small_vector<BufferId, 16> overlap_ids;
@@ -509,10 +610,20 @@ BufferId BufferCache::CreateBuffer(VAddr device_addr, u32 wanted_size) {
     const BufferId new_buffer_id = slot_buffers.insert(
         instance, scheduler, MemoryUsage::DeviceLocal, overlap.begin, AllFlags, size);
     auto& new_buffer = slot_buffers[new_buffer_id];
+    new_buffer.tick_accessed_last = scheduler.CurrentTick();
     const size_t size_bytes = new_buffer.SizeBytes();
-    const auto cmdbuf = scheduler.CommandBuffer();
-    scheduler.EndRendering();
-    cmdbuf.fillBuffer(new_buffer.buffer, 0, size_bytes, 0);
+    auto* const upload_scheduler = scheduler.GetUploadScheduler();
+    if (upload_scheduler && overlap.ids.empty()) {
+        // Nothing references the new buffer yet, initialize it in the upload batch instead of
+        // interrupting rendering.
+        upload_scheduler->CommandBuffer().fillBuffer(new_buffer.buffer, 0, size_bytes, 0);
+        upload_scheduler->ReleaseBuffer(new_buffer.buffer);
+        new_buffer.is_upload_pending = true;
+    } else {
+        const auto cmdbuf = scheduler.CommandBuffer();
+        scheduler.EndRendering();
+        cmdbuf.fillBuffer(new_buffer.buffer, 0, size_bytes, 0);
+    }
     for (const BufferId overlap_id : overlap.ids) {
         JoinOverlap(new_buffer_id, overlap_id, !overlap.has_stream_leap);
     }
@@ -538,16 +649,33 @@ void BufferCache::ChangeRegister(BufferId buffer_id) {
     const u64 page_end = Common::DivCeil(device_addr_end, CACHING_PAGESIZE);
     for (u64 page = page_begin; page != page_end; ++page) {
         if constexpr (insert) {
-            page_table[page] = buffer_id;
+            page_table.Store(page, buffer_id);
         } else {
-            page_table[page] = BufferId{};
+            page_table.Store(page, BufferId{});
         }
     }
+    if constexpr (insert) {
+        GpuStats::Instance().Add(Stat::ResidentBufferBytes, size);
+    } else {
+        GpuStats::Instance().Sub(Stat::ResidentBufferBytes, size);
+    }
+}
+
+bool BufferCache::IsRegionBacked(VAddr addr, size_t size) const {
+    const u64 page_end = Common::DivCeil(addr + size, CACHING_PAGESIZE);
+    for (u64 page = addr >> CACHING_PAGEBITS; page < page_end; ++page) {
+        if (page_table.Load(page)) {
+            return true;
+        }
+    }
+    return false;
 }
 
 void BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size,
                                     bool is_texel_buffer) {
-    std::scoped_lock lk{mutex};
+    // Only the first upload to a new buffer can be batched, later ones may be ordered after
+    // commands that already use it.
+    const bool is_upload_pending = std::exchange(buffer.is_upload_pending, false);
     boost::container::small_vector<vk::BufferCopy, 4> copies;
     u64 total_size_bytes = 0;
     u64 largest_copy = 0;
@@ -569,6 +697,7 @@ void BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size,
     if (total_size_bytes == 0) {
         return;
     }
+    GpuStats::Instance().Add(Stat::UploadBytes, total_size_bytes);
     vk::Buffer src_buffer = staging_buffer.Handle();
     if (total_size_bytes < StagingBufferSize) {
         const auto [staging, offset] = staging_buffer.Map(total_size_bytes);
@@ -580,6 +709,12 @@ void BufferCache::SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size,
             copy.srcOffset += offset;
         }
         staging_buffer.Commit();
+        if (is_upload_pending) {
+            scheduler.GetUploadScheduler()->CommandBuffer().copyBuffer(src_buffer, buffer.buffer,
+                                                                       copies);
+            GpuStats::Instance().Add(Stat::DeferredUploads);
+            return;
+        }
     } else {
         // For large one time transfers use a temporary host buffer.
         // RenderDoc can lag quite a bit if the stream buffer is too large.
@@ -3,7 +3,6 @@
 
 #pragma once
 
-#include <mutex>
 #include <boost/container/small_vector.hpp>
 #include <boost/icl/interval_map.hpp>
 #include <tsl/robin_map.h>
@@ -72,7 +71,13 @@ public:
         return null_buffer_view;
     }
 
-    /// Invalidates any buffer in the logical page range.
+    /// Returns the host visible stream buffer used to stage uploads.
+    [[nodiscard]] StreamBuffer& GetStagingBuffer() noexcept {
+        return staging_buffer;
+    }
+
+    /// Invalidates any buffer in the logical page range. Called from the page fault handlers
+    /// concurrently with the GPU thread.
     void InvalidateMemory(VAddr device_addr, u64 size);
 
     /// Binds host vertex buffers for the current draw.
@@ -105,6 +110,11 @@ public:
 
     [[nodiscard]] BufferId FindBuffer(VAddr device_addr, u32 size);
 
+    /// Frees least recently used buffers that were not accessed for at least min_age ticks until
+    /// bytes_to_free bytes are released, writing back any data modified by the GPU first.
+    /// Returns the number of bytes freed.
+    u64 EvictBuffers(u64 bytes_to_free, u64 min_age);
+
 private:
     template <typename Func>
     void ForEachBufferInRange(VAddr device_addr, u64 size, Func&& func) {
@@ -125,6 +135,12 @@ private:
 
     void DownloadBufferMemory(Buffer& buffer, VAddr device_addr, u64 size);
 
+    /// Appends copies of the GPU modified ranges in the region to a download whose staging data
+    /// starts at dst_offset. Returns the number of bytes added.
+    u64 CollectDownloadCopies(Buffer& buffer, VAddr device_addr, u64 size,
+                              boost::container::small_vector<vk::BufferCopy, 1>& copies,
+                              u64 dst_offset);
+
     [[nodiscard]] OverlapResult ResolveOverlaps(VAddr device_addr, u32 wanted_size);
 
     void JoinOverlap(BufferId new_buffer_id, BufferId overlap_id, bool accumulate_stream_score);
@@ -138,6 +154,9 @@ private:
     template <bool insert>
     void ChangeRegister(BufferId buffer_id);
 
+    /// Lock-free variant of IsRegionRegistered that only consults the page table.
+    [[nodiscard]] bool IsRegionBacked(VAddr addr, size_t size) const;
+
     void SynchronizeBuffer(Buffer& buffer, VAddr device_addr, u32 size, bool is_texel_buffer);
 
     bool SynchronizeBufferFromImage(Buffer& buffer, VAddr device_addr, u32 size);
@@ -152,7 +171,6 @@ private:
     StreamBuffer staging_buffer;
     StreamBuffer stream_buffer;
     Buffer gds_buffer;
-    std::mutex mutex;
     Common::SlotVector<Buffer> slot_buffers;
     RangeSet gpu_modified_ranges;
     vk::BufferView null_buffer_view;
@@ -5,13 +5,20 @@
 
 #include <algorithm>
 #include <deque>
+#include <mutex>
 #include <type_traits>
 #include <vector>
 #include "common/types.h"
 #include "video_core/buffer_cache/word_manager.h"
+#include "video_core/gpu_stats.h"
 
 namespace VideoCore {
 
+/**
+ * Tracks CPU and GPU modified pages of cached memory. The fault handlers and the GPU thread use
+ * it concurrently, each 4MB region is guarded by one of a set of striped locks so that
+ * unrelated regions never block each other.
+ */
 class MemoryTracker {
 public:
     static constexpr size_t MAX_CPU_PAGE_BITS = 39;
@@ -20,6 +27,7 @@ public:
     static constexpr size_t HIGHER_PAGE_MASK = HIGHER_PAGE_SIZE - 1ULL;
     static constexpr size_t NUM_HIGH_PAGES = 1ULL << (MAX_CPU_PAGE_BITS - HIGHER_PAGE_BITS);
     static constexpr size_t MANAGER_POOL_SIZE = 32;
+    static constexpr size_t NUM_LOCK_SHARDS = 64;
     static constexpr size_t WORDS_STACK_NEEDED = HIGHER_PAGE_SIZE / BYTES_PER_WORD;
     using Manager = WordManager<WORDS_STACK_NEEDED>;
 
@@ -122,6 +130,7 @@ private:
         while (remaining_size > 0) {
             const std::size_t copy_amount{
                 std::min<std::size_t>(HIGHER_PAGE_SIZE - page_offset, remaining_size)};
+            const auto lock = LockRegion(page_index);
             auto* manager{top_tier[page_index]};
             if (manager) {
                 if constexpr (BOOL_BREAK) {
@@ -149,8 +158,19 @@ private:
         return false;
     }
 
+    /// Acquires the lock of a region, counting the times it had to wait for another thread.
+    std::unique_lock<std::mutex> LockRegion(std::size_t page_index) {
+        std::unique_lock lock{region_mutexes[page_index % NUM_LOCK_SHARDS], std::try_to_lock};
+        if (!lock.owns_lock()) {
+            GpuStats::Instance().Add(Stat::TrackerLockContended);
+            lock.lock();
+        }
+        return lock;
+    }
+
     void CreateRegion(std::size_t page_index) {
         const VAddr base_cpu_addr = page_index << HIGHER_PAGE_BITS;
+        std::scoped_lock lk{pool_mutex};
         if (free_managers.empty()) {
             manager_pool.emplace_back();
             auto& last_pool = manager_pool.back();
@@ -167,6 +187,8 @@ private:
     }
 
     PageManager* tracker;
+    std::array<std::mutex, NUM_LOCK_SHARDS> region_mutexes;
+    std::mutex pool_mutex;
     std::deque<std::array<Manager, MANAGER_POOL_SIZE>> manager_pool;
     std::vector<Manager*> free_managers;
     std::array<Manager*, NUM_HIGH_PAGES> top_tier{};
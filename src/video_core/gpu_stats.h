@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "common/types.h"
+
+namespace VideoCore {
+
+enum class Stat : u32 {
+    PipelinesPending,
+    PipelinesCompiled,
+    DrawsSkipped,
+    ImagesDetiledHost,
+    ImagesDetiledGpu,
+    TrackerLockContended,
+    PageFaults,
+    PageFaultRanges,
+    ProtectCalls,
+    PipelineKeyRebuilds,
+    ResidentImageBytes,
+    ResidentBufferBytes,
+    EvictedImageBytes,
+    EvictedBufferBytes,
+    PartialImageUploads,
+    UploadBytes,
+    UploadStallUs,
+    DeferredUploads,
+    DescriptorWrites,
+    CommandChunks,
+    NumStats,
+};
+
+struct StatInfo {
+    const char* name;
+    bool is_gauge; ///< Gauges hold a current value, counters only ever increase.
+};
+
+constexpr std::array<StatInfo, static_cast<size_t>(Stat::NumStats)> StatInfos = {{
+    {"Pipelines compiling", true},
+    {"Pipelines compiled", false},
+    {"Draws skipped", false},
+    {"Images detiled (CPU)", false},
+    {"Images detiled (GPU)", false},
+    {"Tracker lock waits", false},
+    {"Write faults", false},
+    {"Write fault ranges", false},
+    {"Protect calls", false},
+    {"Pipeline key rebuilds", false},
+    {"Resident image bytes", true},
+    {"Resident buffer bytes", true},
+    {"Evicted image bytes", false},
+    {"Evicted buffer bytes", false},
+    {"Partial image uploads", false},
+    {"Upload bytes", false},
+    {"Upload stall (us)", false},
+    {"Uploads batched", false},
+    {"Descriptor writes", false},
+    {"Command chunks", false},
+}};
+
+/**
+ * Renderer counters sampled by the devtools overlay. Counters are monotonic and per-frame values
+ * are derived by the reader from the difference between flips.
+ */
+class GpuStats {
+public:
+    static GpuStats& Instance() {
+        static GpuStats instance;
+        return instance;
+    }
+
+    void Add(Stat stat, u64 value = 1) {
+        values[Index(stat)].fetch_add(value, std::memory_order_relaxed);
+    }
+
+    void Sub(Stat stat, u64 value = 1) {
+        values[Index(stat)].fetch_sub(value, std::memory_order_relaxed);
+    }
+
+    void Set(Stat stat, u64 value) {
+        values[Index(stat)].store(value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] u64 Get(Stat stat) const {
+        return values[Index(stat)].load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr size_t Index(Stat stat) {
+        return static_cast<size_t>(stat);
+    }
+
+    std::array<std::atomic<u64>, static_cast<size_t>(Stat::NumStats)> values{};
+};
+
+} // namespace VideoCore
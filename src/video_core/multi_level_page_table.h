@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -52,11 +53,31 @@ public:
         const size_t l1_page = page >> SecondLevelBits;
         const size_t l2_page = page & (NumEntriesPerL1Page - 1);
         if (!first_level_map[l1_page]) {
-            first_level_map[l1_page] = page_alloc.Create();
+            // Published atomically so that concurrent Load calls see a fully constructed page.
+            std::atomic_ref{first_level_map[l1_page]}.store(page_alloc.Create(),
+                                                            std::memory_order_release);
         }
         return (*first_level_map[l1_page])[l2_page];
     }
 
+    /// Reads an entry without allocating. Safe to call from other threads as long as the
+    /// owning thread modifies entries through Store.
+    [[nodiscard]] Entry Load(size_t page) const noexcept {
+        const size_t l1_page = page >> SecondLevelBits;
+        const size_t l2_page = page & (NumEntriesPerL1Page - 1);
+        auto& l1_ref = const_cast<L1Page*&>(first_level_map[l1_page]);
+        auto* const l1 = std::atomic_ref{l1_ref}.load(std::memory_order_acquire);
+        if (!l1) {
+            return Entry{};
+        }
+        return std::atomic_ref{(*l1)[l2_page]}.load(std::memory_order_acquire);
+    }
+
+    /// Writes an entry so that it can be observed by concurrent Load calls.
+    void Store(size_t page, Entry entry) {
+        std::atomic_ref{(*this)[page]}.store(entry, std::memory_order_release);
+    }
+
 private:
     std::vector<L1Page*> first_level_map{};
     Common::ObjectPool<L1Page> page_alloc;
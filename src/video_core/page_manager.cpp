@@ -1,6 +1,9 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <array>
+#include <cstdlib>
 #include <thread>
 #include <boost/icl/interval_set.hpp>
 #include "common/alignment.h"
@@ -9,6 +12,7 @@
 #include "common/signal_context.h"
 #include "core/memory.h"
 #include "core/signals.h"
+#include "video_core/gpu_stats.h"
 #include "video_core/page_manager.h"
 #include "video_core/renderer_vulkan/vk_rasterizer.h"
 
@@ -31,6 +35,8 @@ constexpr size_t PAGEBITS = 12;
 
 #if ENABLE_USERFAULTFD
 struct PageManager::Impl {
+    static constexpr size_t MaxFaultBatch = 64;
+
     Impl(Vulkan::Rasterizer* rasterizer_) : rasterizer{rasterizer_} {
         uffd = syscall(__NR_userfaultfd, O_CLOEXEC | O_NONBLOCK);
         ASSERT_MSG(uffd != -1, "{}", Common::GetLastErrorMsg());
@@ -102,20 +108,39 @@ struct PageManager::Impl {
                 continue;
             }
 
-            // Read message from kernel.
-            uffd_msg msg;
-            const int readret = read(uffd, &msg, sizeof(msg));
-            ASSERT_MSG(readret != -1 || errno == EAGAIN, "Unexpected result of uffd read");
-            if (errno == EAGAIN) {
+            // Drain as many pending messages as possible, the kernel fills the whole buffer
+            // without blocking once the first message is available.
+            std::array<uffd_msg, MaxFaultBatch> msgs;
+            const ssize_t readret = read(uffd, msgs.data(), sizeof(msgs));
+            if (readret == -1) {
+                ASSERT_MSG(errno == EAGAIN, "Unexpected result of uffd read");
                 continue;
             }
-            ASSERT_MSG(readret == sizeof(msg), "Unexpected short read, exiting");
-            ASSERT(msg.arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP);
+            ASSERT_MSG(readret % sizeof(uffd_msg) == 0, "Unexpected short read, exiting");
+            const size_t num_msgs = readret / sizeof(uffd_msg);
 
-            // Notify rasterizer about the fault.
-            const VAddr addr = msg.arg.pagefault.address;
-            const VAddr addr_page = Common::AlignDown(addr, PAGESIZE);
-            rasterizer->InvalidateMemory(addr_page, PAGESIZE);
+            std::array<VAddr, MaxFaultBatch> pages;
+            for (size_t i = 0; i < num_msgs; ++i) {
+                ASSERT(msgs[i].arg.pagefault.flags & UFFD_PAGEFAULT_FLAG_WP);
+                pages[i] = Common::AlignDown(msgs[i].arg.pagefault.address, PAGESIZE);
+            }
+            std::sort(pages.begin(), pages.begin() + num_msgs);
+
+            // Notify rasterizer about the faults, merging adjacent pages into one invalidation.
+            size_t num_ranges = 0;
+            for (size_t i = 0; i < num_msgs;) {
+                const VAddr range_start = pages[i];
+                VAddr range_end = range_start + PAGESIZE;
+                while (++i < num_msgs && pages[i] <= range_end) {
+                    range_end = pages[i] + PAGESIZE;
+                }
+                rasterizer->InvalidateMemory(range_start, range_end - range_start);
+                ++num_ranges;
+            }
+
+            auto& stats = GpuStats::Instance();
+            stats.Add(Stat::PageFaults, num_msgs);
+            stats.Add(Stat::PageFaultRanges, num_ranges);
         }
     }
 
@@ -159,6 +184,9 @@ struct PageManager::Impl {
         if (is_write && owned_ranges.find(addr) != owned_ranges.end()) {
             const VAddr addr_aligned = Common::AlignDown(addr, PAGESIZE);
             rasterizer->InvalidateMemory(addr_aligned, PAGESIZE);
+            auto& stats = GpuStats::Instance();
+            stats.Add(Stat::PageFaults);
+            stats.Add(Stat::PageFaultRanges);
             return true;
         }
         return false;
@@ -196,20 +224,34 @@ void PageManager::UpdatePagesCachedCount(VAddr addr, u64 size, s32 delta) {
         cached_pages.add({pages_interval, delta});
     }
 
+    // Neighbouring intervals that cross the protection threshold are merged so that a range
+    // spanning several cache entries is changed with a single call.
+    const bool allow_write = delta < 0;
+    VAddr protect_start = 0;
+    VAddr protect_end = 0;
+    const auto flush_protect = [&] {
+        if (protect_end != protect_start) {
+            impl->Protect(protect_start, protect_end - protect_start, allow_write);
+            GpuStats::Instance().Add(Stat::ProtectCalls);
+        }
+    };
+
     const auto& range = cached_pages.equal_range(pages_interval);
     for (const auto& [range, count] : boost::make_iterator_range(range)) {
+        if (count != std::abs(delta)) {
+            ASSERT(count >= 0);
+            continue;
+        }
         const auto interval = range & pages_interval;
         const VAddr interval_start_addr = boost::icl::first(interval) << PageShift;
         const VAddr interval_end_addr = boost::icl::last_next(interval) << PageShift;
-        const u32 interval_size = interval_end_addr - interval_start_addr;
-        if (delta > 0 && count == delta) {
-            impl->Protect(interval_start_addr, interval_size, false);
-        } else if (delta < 0 && count == -delta) {
-            impl->Protect(interval_start_addr, interval_size, true);
-        } else {
-            ASSERT(count >= 0);
+        if (interval_start_addr != protect_end) {
+            flush_protect();
+            protect_start = interval_start_addr;
         }
+        protect_end = interval_end_addr;
     }
+    flush_protect();
 
     if (delta < 0) {
         cached_pages.add({pages_interval, delta});
@@ -14,15 +14,9 @@ namespace Vulkan {
 ComputePipeline::ComputePipeline(const Instance& instance_, Scheduler& scheduler_,
                                  DescriptorHeap& desc_heap_, vk::PipelineCache pipeline_cache,
                                  u64 compute_key_, const Shader::Info& info_,
-                                 vk::ShaderModule module)
+                                 vk::ShaderModule module, Common::ThreadWorker* worker)
     : Pipeline{instance_, scheduler_, desc_heap_, pipeline_cache}, compute_key{compute_key_},
       info{&info_} {
-    const vk::PipelineShaderStageCreateInfo shader_ci = {
-        .stage = vk::ShaderStageFlagBits::eCompute,
-        .module = module,
-        .pName = "main",
-    };
-
     u32 binding{};
     boost::container::small_vector<vk::DescriptorSetLayoutBinding, 32> bindings;
 
@@ -105,15 +99,23 @@ ComputePipeline::ComputePipeline(const Instance& instance_, Scheduler& scheduler
                "Failed to create compute pipeline layout: {}", vk::to_string(layout_result));
     pipeline_layout = std::move(layout);
 
-    const vk::ComputePipelineCreateInfo compute_pipeline_ci = {
-        .stage = shader_ci,
-        .layout = *pipeline_layout,
-    };
-    auto [pipeline_result, pipe] =
-        instance.GetDevice().createComputePipelineUnique(pipeline_cache, compute_pipeline_ci);
-    ASSERT_MSG(pipeline_result == vk::Result::eSuccess, "Failed to create compute pipeline: {}",
-               vk::to_string(pipeline_result));
-    pipeline = std::move(pipe);
+    // The layout above depends on the bound sharps, only the driver compilation is deferred.
+    Compile(worker, [this, pipeline_cache, module] {
+        const vk::PipelineShaderStageCreateInfo shader_ci = {
+            .stage = vk::ShaderStageFlagBits::eCompute,
+            .module = module,
+            .pName = "main",
+        };
+        const vk::ComputePipelineCreateInfo compute_pipeline_ci = {
+            .stage = shader_ci,
+            .layout = *pipeline_layout,
+        };
+        auto [pipeline_result, pipe] =
+            instance.GetDevice().createComputePipelineUnique(pipeline_cache, compute_pipeline_ci);
+        ASSERT_MSG(pipeline_result == vk::Result::eSuccess,
+                   "Failed to create compute pipeline: {}", vk::to_string(pipeline_result));
+        return std::move(pipe);
+    });
 }
 
 ComputePipeline::~ComputePipeline() = default;
@@ -174,7 +176,6 @@ bool ComputePipeline::BindResources(VideoCore::BufferCache& buffer_cache,
         return false;
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
     if (!buffer_barriers.empty()) {
         const auto dependencies = vk::DependencyInfo{
             .dependencyFlags = vk::DependencyFlagBits::eByRegion,
@@ -182,25 +183,16 @@ bool ComputePipeline::BindResources(VideoCore::BufferCache& buffer_cache,
             .pBufferMemoryBarriers = buffer_barriers.data(),
         };
         scheduler.EndRendering();
-        cmdbuf.pipelineBarrier2(dependencies);
+        scheduler.CommandBuffer().pipelineBarrier2(dependencies);
     }
 
-    cmdbuf.pushConstants(*pipeline_layout, vk::ShaderStageFlagBits::eCompute, 0u, sizeof(push_data),
-                         &push_data);
+    scheduler.RecordState([layout = *pipeline_layout, push_data](vk::CommandBuffer cmdbuf) {
+        cmdbuf.pushConstants(layout, vk::ShaderStageFlagBits::eCompute, 0u, sizeof(push_data),
+                             &push_data);
+    });
 
     // Bind descriptor set.
-    if (uses_push_descriptors) {
-        cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, *pipeline_layout, 0,
-                                    set_writes);
-        return true;
-    }
-    const auto desc_set = desc_heap.Commit(*desc_layout);
-    for (auto& set_write : set_writes) {
-        set_write.dstSet = desc_set;
-    }
-    instance.GetDevice().updateDescriptorSets(set_writes, {});
-    cmdbuf.bindDescriptorSets(vk::PipelineBindPoint::eCompute, *pipeline_layout, 0, desc_set, {});
-
+    BindDescriptors(vk::PipelineBindPoint::eCompute, uses_push_descriptors, set_writes);
     return true;
 }
 
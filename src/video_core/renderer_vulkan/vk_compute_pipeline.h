@@ -21,7 +21,7 @@ class ComputePipeline : public Pipeline {
 public:
     ComputePipeline(const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
                     vk::PipelineCache pipeline_cache, u64 compute_key, const Shader::Info& info,
-                    vk::ShaderModule module);
+                    vk::ShaderModule module, Common::ThreadWorker* worker);
     ~ComputePipeline();
 
     bool BindResources(VideoCore::BufferCache& buffer_cache,
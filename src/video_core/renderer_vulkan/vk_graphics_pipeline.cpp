@@ -24,9 +24,9 @@ GraphicsPipeline::GraphicsPipeline(const Instance& instance_, Scheduler& schedul
                                    DescriptorHeap& desc_heap_, const GraphicsPipelineKey& key_,
                                    vk::PipelineCache pipeline_cache,
                                    std::span<const Shader::Info*, MaxShaderStages> infos,
-                                   std::span<const vk::ShaderModule> modules)
+                                   std::span<const vk::ShaderModule> modules,
+                                   Common::ThreadWorker* worker)
     : Pipeline{instance_, scheduler_, desc_heap_, pipeline_cache}, key{key_} {
-    const vk::Device device = instance.GetDevice();
     std::ranges::copy(infos, stages.begin());
     BuildDescSetLayout();
 
@@ -80,6 +80,22 @@ GraphicsPipeline::GraphicsPipeline(const Instance& instance_, Scheduler& schedul
         }
     }
 
+    // Everything above depends on guest state at the time of the draw. The remaining work only
+    // uses the pipeline key and copied data, so it can safely run on a compiler thread.
+    std::array<vk::ShaderModule, MaxShaderStages> stage_modules{};
+    std::ranges::copy(modules, stage_modules.begin());
+    Compile(worker, [this, pipeline_cache, vertex_bindings, vertex_attributes, stage_modules] {
+        return Build(pipeline_cache, {vertex_bindings.data(), vertex_bindings.size()},
+                     {vertex_attributes.data(), vertex_attributes.size()}, stage_modules);
+    });
+}
+
+vk::UniquePipeline GraphicsPipeline::Build(
+    vk::PipelineCache pipeline_cache,
+    std::span<const vk::VertexInputBindingDescription> vertex_bindings,
+    std::span<const vk::VertexInputAttributeDescription> vertex_attributes,
+    std::span<const vk::ShaderModule, MaxShaderStages> modules) const {
+    const vk::Device device = instance.GetDevice();
     const vk::PipelineVertexInputStateCreateInfo vertex_input_info = {
         .vertexBindingDescriptionCount = static_cast<u32>(vertex_bindings.size()),
         .pVertexBindingDescriptions = vertex_bindings.data(),
@@ -203,7 +219,7 @@ GraphicsPipeline::GraphicsPipeline(const Instance& instance_, Scheduler& schedul
     boost::container::static_vector<vk::PipelineShaderStageCreateInfo, MaxShaderStages>
         shader_stages;
     auto stage = u32(Shader::Stage::Vertex);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eVertex,
             .module = modules[stage],
@@ -211,7 +227,7 @@ GraphicsPipeline::GraphicsPipeline(const Instance& instance_, Scheduler& schedul
         });
     }
     stage = u32(Shader::Stage::Geometry);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eGeometry,
             .module = modules[stage],
@@ -219,7 +235,7 @@ GraphicsPipeline::GraphicsPipeline(const Instance& instance_, Scheduler& schedul
         });
     }
     stage = u32(Shader::Stage::Fragment);
-    if (infos[stage]) {
+    if (stages[stage]) {
         shader_stages.emplace_back(vk::PipelineShaderStageCreateInfo{
             .stage = vk::ShaderStageFlagBits::eFragment,
             .module = modules[stage],
@@ -314,7 +330,7 @@ GraphicsPipeline::GraphicsPipeline(const Instance& instance_, Scheduler& schedul
         device.createGraphicsPipelineUnique(pipeline_cache, pipeline_info);
     ASSERT_MSG(pipeline_result == vk::Result::eSuccess, "Failed to create graphics pipeline: {}",
                vk::to_string(pipeline_result));
-    pipeline = std::move(pipe);
+    return std::move(pipe);
 }
 
 GraphicsPipeline::~GraphicsPipeline() = default;
@@ -418,10 +434,12 @@ void GraphicsPipeline::BindResources(const Liverpool::Regs& regs,
         BindTextures(texture_cache, *stage, binding, set_writes);
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
     SCOPE_EXIT {
-        cmdbuf.pushConstants(*pipeline_layout, gp_stage_flags, 0U, sizeof(push_data), &push_data);
-        cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, Handle());
+        scheduler.RecordState([layout = *pipeline_layout, handle = Handle(),
+                               push_data](vk::CommandBuffer cmdbuf) {
+            cmdbuf.pushConstants(layout, gp_stage_flags, 0U, sizeof(push_data), &push_data);
+            cmdbuf.bindPipeline(vk::PipelineBindPoint::eGraphics, handle);
+        });
     };
 
     if (set_writes.empty()) {
@@ -435,21 +453,11 @@ void GraphicsPipeline::BindResources(const Liverpool::Regs& regs,
             .pBufferMemoryBarriers = buffer_barriers.data(),
         };
         scheduler.EndRendering();
-        cmdbuf.pipelineBarrier2(dependencies);
+        scheduler.CommandBuffer().pipelineBarrier2(dependencies);
     }
 
     // Bind descriptor set.
-    if (uses_push_descriptors) {
-        cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eGraphics, *pipeline_layout, 0,
-                                    set_writes);
-        return;
-    }
-    const auto desc_set = desc_heap.Commit(*desc_layout);
-    for (auto& set_write : set_writes) {
-        set_write.dstSet = desc_set;
-    }
-    instance.GetDevice().updateDescriptorSets(set_writes, {});
-    cmdbuf.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, *pipeline_layout, 0, desc_set, {});
+    BindDescriptors(vk::PipelineBindPoint::eGraphics, uses_push_descriptors, set_writes);
 }
 
 } // namespace Vulkan
@@ -7,6 +7,10 @@
 #include "video_core/renderer_vulkan/vk_common.h"
 #include "video_core/renderer_vulkan/vk_pipeline_common.h"
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace VideoCore {
 class BufferCache;
 class TextureCache;
@@ -58,7 +62,7 @@ public:
     GraphicsPipeline(const Instance& instance, Scheduler& scheduler, DescriptorHeap& desc_heap,
                      const GraphicsPipelineKey& key, vk::PipelineCache pipeline_cache,
                      std::span<const Shader::Info*, MaxShaderStages> stages,
-                     std::span<const vk::ShaderModule> modules);
+                     std::span<const vk::ShaderModule> modules, Common::ThreadWorker* worker);
     ~GraphicsPipeline();
 
     void BindResources(const Liverpool::Regs& regs, VideoCore::BufferCache& buffer_cache,
@@ -97,6 +101,10 @@ public:
 
 private:
     void BuildDescSetLayout();
+    vk::UniquePipeline Build(vk::PipelineCache pipeline_cache,
+                             std::span<const vk::VertexInputBindingDescription> vertex_bindings,
+                             std::span<const vk::VertexInputAttributeDescription> vertex_attributes,
+                             std::span<const vk::ShaderModule, MaxShaderStages> modules) const;
 
 private:
     std::array<const Shader::Info*, MaxShaderStages> stages{};
@@ -1,6 +1,7 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <array>
 #include <ranges>
 #include <span>
 #include <boost/container/static_vector.hpp>
@@ -264,6 +265,7 @@ bool Instance::CreateDevice() {
     const bool robustness = add_extension(VK_EXT_ROBUSTNESS_2_EXTENSION_NAME);
     list_restart = add_extension(VK_EXT_PRIMITIVE_TOPOLOGY_LIST_RESTART_EXTENSION_NAME);
     maintenance5 = add_extension(VK_KHR_MAINTENANCE_5_EXTENSION_NAME);
+    memory_budget = add_extension(VK_EXT_MEMORY_BUDGET_EXTENSION_NAME);
 
     // These extensions are promoted by Vulkan 1.3, but for greater compatibility we use Vulkan 1.2
     // with extensions.
@@ -291,9 +293,16 @@ bool Instance::CreateDevice() {
     bool graphics_queue_found = false;
     for (std::size_t i = 0; i < family_properties.size(); i++) {
         const u32 index = static_cast<u32>(i);
-        if (family_properties[i].queueFlags & vk::QueueFlagBits::eGraphics) {
+        const auto queue_flags = family_properties[i].queueFlags;
+        if (queue_flags & vk::QueueFlagBits::eGraphics) {
             queue_family_index = index;
             graphics_queue_found = true;
+        } else if (!(queue_flags & vk::QueueFlagBits::eCompute) &&
+                   (queue_flags & vk::QueueFlagBits::eTransfer) &&
+                   !transfer_queue_family_index) {
+            // Queues of a transfer-only family usually map to a DMA engine that can upload data
+            // while the graphics queue is busy.
+            transfer_queue_family_index = index;
         }
     }
 
@@ -304,17 +313,25 @@ bool Instance::CreateDevice() {
 
     static constexpr std::array<f32, 1> queue_priorities = {1.0f};
 
-    const vk::DeviceQueueCreateInfo queue_info = {
+    boost::container::static_vector<vk::DeviceQueueCreateInfo, 2> queue_infos;
+    queue_infos.push_back({
         .queueFamilyIndex = queue_family_index,
         .queueCount = static_cast<u32>(queue_priorities.size()),
         .pQueuePriorities = queue_priorities.data(),
-    };
+    });
+    if (transfer_queue_family_index) {
+        queue_infos.push_back({
+            .queueFamilyIndex = *transfer_queue_family_index,
+            .queueCount = static_cast<u32>(queue_priorities.size()),
+            .pQueuePriorities = queue_priorities.data(),
+        });
+    }
 
     const auto vk12_features = feature_chain.get<vk::PhysicalDeviceVulkan12Features>();
     vk::StructureChain device_chain = {
         vk::DeviceCreateInfo{
-            .queueCreateInfoCount = 1u,
-            .pQueueCreateInfos = &queue_info,
+            .queueCreateInfoCount = static_cast<u32>(queue_infos.size()),
+            .pQueueCreateInfos = queue_infos.data(),
             .enabledExtensionCount = static_cast<u32>(enabled_extensions.size()),
             .ppEnabledExtensionNames = enabled_extensions.data(),
         },
@@ -450,6 +467,9 @@ bool Instance::CreateDevice() {
 
     graphics_queue = device->getQueue(queue_family_index, 0);
     present_queue = device->getQueue(queue_family_index, 0);
+    if (transfer_queue_family_index) {
+        transfer_queue = device->getQueue(*transfer_queue_family_index, 0);
+    }
 
     if (calibrated_timestamps) {
         const auto [time_domains_result, time_domains] =
@@ -493,6 +513,7 @@ void Instance::CreateAllocator() {
     };
 
     const VmaAllocatorCreateInfo allocator_info = {
+        .flags = memory_budget ? VMA_ALLOCATOR_CREATE_EXT_MEMORY_BUDGET_BIT : 0u,
         .physicalDevice = physical_device,
         .device = *device,
         .pVulkanFunctions = &functions,
@@ -507,6 +528,23 @@ void Instance::CreateAllocator() {
     }
 }
 
+MemoryBudget Instance::GetDeviceLocalMemoryBudget() const {
+    // Without VK_EXT_memory_budget VMA estimates the values from its own allocations.
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{};
+    vmaGetHeapBudgets(allocator, budgets.data());
+    const VkPhysicalDeviceMemoryProperties* memory_properties{};
+    vmaGetMemoryProperties(allocator, &memory_properties);
+
+    MemoryBudget result{};
+    for (u32 i = 0; i < memory_properties->memoryHeapCount; ++i) {
+        if (memory_properties->memoryHeaps[i].flags & VK_MEMORY_HEAP_DEVICE_LOCAL_BIT) {
+            result.usage += budgets[i].usage;
+            result.budget += budgets[i].budget;
+        }
+    }
+    return result;
+}
+
 void Instance::CollectDeviceParameters() {
     const vk::StructureChain property_chain =
         physical_device
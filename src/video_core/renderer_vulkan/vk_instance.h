@@ -3,6 +3,7 @@
 
 #pragma once
 
+#include <optional>
 #include <span>
 #include <unordered_map>
 
@@ -19,6 +20,11 @@ VK_DEFINE_HANDLE(VmaAllocator)
 
 namespace Vulkan {
 
+struct MemoryBudget {
+    u64 usage;  ///< Bytes currently allocated by the process.
+    u64 budget; ///< Bytes the process can allocate before running into trouble.
+};
+
 class Instance {
 public:
     explicit Instance(bool validation = false, bool crash_diagnostic = false);
@@ -79,6 +85,19 @@ public:
         return present_queue;
     }
 
+    /// Returns true when the device exposes a queue family dedicated to transfers.
+    bool HasTransferQueue() const {
+        return transfer_queue_family_index.has_value();
+    }
+
+    u32 GetTransferQueueFamilyIndex() const {
+        return transfer_queue_family_index.value_or(queue_family_index);
+    }
+
+    vk::Queue GetTransferQueue() const {
+        return transfer_queue;
+    }
+
     TracyVkCtx GetProfilerContext() const {
         return profiler_context;
     }
@@ -113,6 +132,11 @@ public:
         return shader_stencil_export;
     }
 
+    /// Returns true when VK_EXT_memory_budget is supported
+    bool IsMemoryBudgetSupported() const {
+        return memory_budget;
+    }
+
     /// Returns true when VK_EXT_external_memory_host is supported
     bool IsExternalMemoryHostSupported() const {
         return external_memory_host;
@@ -257,6 +281,9 @@ public:
         return min_imported_host_pointer_alignment;
     }
 
+    /// Returns the combined usage and budget of the device local memory heaps.
+    [[nodiscard]] MemoryBudget GetDeviceLocalMemoryBudget() const;
+
     /// Returns the sample count flags supported by framebuffers.
     vk::SampleCountFlags GetFramebufferSampleCounts() const {
         return properties.limits.framebufferColorSampleCounts &
@@ -295,11 +322,13 @@ private:
     VmaAllocator allocator{};
     vk::Queue present_queue;
     vk::Queue graphics_queue;
+    vk::Queue transfer_queue;
     std::vector<vk::PhysicalDevice> physical_devices;
     std::vector<std::string> available_extensions;
     std::unordered_map<vk::Format, vk::FormatProperties3> format_properties;
     TracyVkCtx profiler_context{};
     u32 queue_family_index{0};
+    std::optional<u32> transfer_queue_family_index;
     bool image_view_reinterpretation{true};
     bool timeline_semaphores{};
     bool custom_border_color{};
@@ -308,6 +337,7 @@ private:
     bool fragment_shader_barycentric{};
     bool shader_stencil_export{};
     bool external_memory_host{};
+    bool memory_budget{};
     bool depth_clip_control{};
     bool workgroup_memory_explicit_layout{};
     bool color_write_en{};
@@ -7,10 +7,13 @@
 #include "common/hash.h"
 #include "common/io_file.h"
 #include "common/path_util.h"
+#include "common/thread_worker.h"
 #include "shader_recompiler/backend/spirv/emit_spirv.h"
 #include "shader_recompiler/info.h"
 #include "shader_recompiler/recompiler.h"
+#include "shader_recompiler/replay.h"
 #include "shader_recompiler/runtime_info.h"
+#include "video_core/gpu_stats.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_cache.h"
 #include "video_core/renderer_vulkan/vk_presenter.h"
@@ -23,6 +26,9 @@ namespace Vulkan {
 
 using Shader::VsOutput;
 
+// Number of newly created pipelines after which the driver pipeline cache is written back to disk.
+constexpr static u32 PipelineCacheSaveInterval = 32;
+
 constexpr static std::array DescriptorHeapSizes = {
     vk::DescriptorPoolSize{vk::DescriptorType::eUniformBuffer, 8192},
     vk::DescriptorPoolSize{vk::DescriptorType::eStorageBuffer, 1024},
@@ -160,7 +166,8 @@ Shader::RuntimeInfo PipelineCache::BuildRuntimeInfo(Shader::Stage stage) {
 PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
                              AmdGpu::Liverpool* liverpool_)
     : instance{instance_}, scheduler{scheduler_}, liverpool{liverpool_},
-      desc_heap{instance, scheduler.GetMasterSemaphore(), DescriptorHeapSizes} {
+      desc_heap{instance, scheduler.GetMasterSemaphore(), DescriptorHeapSizes},
+      shader_cache{instance} {
     const auto& vk12_props = instance.GetVk12Properties();
     profile = Shader::Profile{
         .supported_spirv = instance.ApiVersion() >= VK_API_VERSION_1_3 ? 0x00010600U : 0x00010500U,
@@ -169,13 +176,38 @@ PipelineCache::PipelineCache(const Instance& instance_, Scheduler& scheduler_,
         .support_fp32_denorm_flush = bool(vk12_props.shaderDenormFlushToZeroFloat32),
         .support_explicit_workgroup_layout = true,
     };
-    auto [cache_result, cache] = instance.GetDevice().createPipelineCacheUnique({});
+    const auto cache_data = shader_cache.LoadPipelineData();
+    auto [cache_result, cache] = instance.GetDevice().createPipelineCacheUnique({
+        .initialDataSize = cache_data.size(),
+        .pInitialData = cache_data.data(),
+    });
+    if (cache_result != vk::Result::eSuccess && !cache_data.empty()) {
+        LOG_WARNING(Render_Vulkan, "Driver rejected saved pipeline cache: {}",
+                    vk::to_string(cache_result));
+        auto [retry_result, retry_cache] = instance.GetDevice().createPipelineCacheUnique({});
+        cache_result = retry_result;
+        cache = std::move(retry_cache);
+    }
     ASSERT_MSG(cache_result == vk::Result::eSuccess, "Failed to create pipeline cache: {}",
                vk::to_string(cache_result));
     pipeline_cache = std::move(cache);
+
+    if (const u32 num_threads = Config::pipelineCompileThreads(); num_threads != 0) {
+        compile_worker =
+            std::make_unique<Common::ThreadWorker>(num_threads, "shadPS4:PipelineCompiler");
+    }
 }
 
-PipelineCache::~PipelineCache() = default;
+PipelineCache::~PipelineCache() {
+    // Stop the compiler threads before the pipelines they are building are destroyed.
+    compile_worker.reset();
+    if (num_new_pipelines != 0) {
+        const auto [result, data] = instance.GetDevice().getPipelineCacheData(*pipeline_cache);
+        if (result == vk::Result::eSuccess) {
+            shader_cache.SavePipelineData(data);
+        }
+    }
+}
 
 const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
     if (!RefreshGraphicsKey()) {
@@ -184,9 +216,19 @@ const GraphicsPipeline* PipelineCache::GetGraphicsPipeline() {
     const auto [it, is_new] = graphics_pipelines.try_emplace(graphics_key);
     if (is_new) {
         it.value() = graphics_pipeline_pool.Create(instance, scheduler, desc_heap, graphics_key,
-                                                   *pipeline_cache, infos, modules);
+                                                   *pipeline_cache, infos, modules,
+                                                   compile_worker.get());
+        OnPipelineCreated();
+    }
+    const GraphicsPipeline* pipeline = it->second;
+    if (!pipeline->IsReady()) {
+        if (Config::skipPendingPipelineDraws()) {
+            VideoCore::GpuStats::Instance().Add(VideoCore::Stat::DrawsSkipped);
+            return nullptr;
+        }
+        pipeline->WaitReady();
     }
-    return it->second;
+    return pipeline;
 }
 
 const ComputePipeline* PipelineCache::GetComputePipeline() {
@@ -196,16 +238,32 @@ const ComputePipeline* PipelineCache::GetComputePipeline() {
     const auto [it, is_new] = compute_pipelines.try_emplace(compute_key);
     if (is_new) {
         it.value() = compute_pipeline_pool.Create(instance, scheduler, desc_heap, *pipeline_cache,
-                                                  compute_key, *infos[0], modules[0]);
+                                                  compute_key, *infos[0], modules[0],
+                                                  compile_worker.get());
+        OnPipelineCreated();
     }
-    return it->second;
+    // Dispatches often produce data consumed later by the CPU, so they are never skipped.
+    const ComputePipeline* pipeline = it->second;
+    pipeline->WaitReady();
+    return pipeline;
 }
 
-bool PipelineCache::RefreshGraphicsKey() {
-    std::memset(&graphics_key, 0, sizeof(GraphicsPipelineKey));
+void PipelineCache::OnPipelineCreated() {
+    // Periodically persist the driver cache so that crashes and forced exits lose little work.
+    if (++num_new_pipelines % PipelineCacheSaveInterval != 0 || !shader_cache.IsEnabled()) {
+        return;
+    }
+    const auto [result, data] = instance.GetDevice().getPipelineCacheData(*pipeline_cache);
+    if (result == vk::Result::eSuccess) {
+        shader_cache.SavePipelineData(data);
+    }
+}
+
+void PipelineCache::RefreshRenderStateKey() {
+    std::memset(&render_state_key, 0, sizeof(GraphicsPipelineKey));
 
     auto& regs = liverpool->regs;
-    auto& key = graphics_key;
+    auto& key = render_state_key;
 
     key.depth_stencil = regs.depth_control;
     key.depth_stencil.depth_write_enable.Assign(regs.depth_control.depth_write_enable.Value() &&
@@ -243,8 +301,7 @@ bool PipelineCache::RefreshGraphicsKey() {
     key.front_face = regs.polygon_control.front_face;
     key.num_samples = regs.aa_config.NumSamples();
 
-    const bool skip_cb_binding =
-        regs.color_control.mode == AmdGpu::Liverpool::ColorControl::OperationMode::Disable;
+    const bool skip_cb_binding = IsColorBindingSkipped();
 
     // `RenderingInfo` is assumed to be initialized with a contiguous array of valid color
     // attachments. This might be not a case as HW color buffers can be bound in an arbitrary
@@ -275,6 +332,27 @@ bool PipelineCache::RefreshGraphicsKey() {
         ++remapped_cb;
     }
 
+    VideoCore::GpuStats::Instance().Add(VideoCore::Stat::PipelineKeyRebuilds);
+}
+
+bool PipelineCache::IsColorBindingSkipped() const {
+    return liverpool->regs.color_control.mode ==
+           AmdGpu::Liverpool::ColorControl::OperationMode::Disable;
+}
+
+bool PipelineCache::RefreshGraphicsKey() {
+    // Only the shader stages depend on guest memory, everything derived from the registers alone
+    // is rebuilt when a register write actually changed a value since the previous draw.
+    if (render_state_version != liverpool->regs_version) {
+        RefreshRenderStateKey();
+        render_state_version = liverpool->regs_version;
+    }
+    graphics_key = render_state_key;
+
+    auto& regs = liverpool->regs;
+    auto& key = graphics_key;
+    const bool skip_cb_binding = IsColorBindingSkipped();
+
     Shader::Backend::Bindings binding{};
     const auto& TryBindStageRemap = [&](Shader::Stage stage_in, Shader::Stage stage_out) -> bool {
         const auto stage_in_idx = static_cast<u32>(stage_in);
@@ -405,8 +483,31 @@ vk::ShaderModule PipelineCache::CompileModule(Shader::Info& info,
              perm_idx != 0 ? "(permutation)" : "");
     DumpShader(code, info.pgm_hash, info.stage, perm_idx, "bin");
 
+    const auto start = binding;
     const auto ir_program = Shader::TranslateProgram(code, pools, info, runtime_info, profile);
-    const auto spv = Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, ir_program, binding);
+    if (Config::dumpShaders()) {
+        using namespace Common::FS;
+        const auto filename =
+            fmt::format("{}_{:#018x}_{}.ctx", info.stage, info.pgm_hash, perm_idx);
+        Shader::DumpTranslationContext(GetUserPath(PathType::ShaderDir) / "dumps" / filename, info,
+                                       runtime_info, profile, start);
+    }
+
+    // Translation still runs on a hit, it fills the resource information of the shader that the
+    // rasterizer binds from, including the JIT-compiled SRT walker which cannot be stored. The
+    // module key depends on that information, so only SPIR-V emission is skipped when this
+    // permutation was compiled in a previous session.
+    const auto spec = Shader::StageSpecialization(info, runtime_info, start);
+    const u64 cache_key = ShaderCache::ComputeModuleKey(info.pgm_hash, spec);
+    std::vector<u32> emitted_spv;
+    auto spv = shader_cache.FindModule(cache_key);
+    if (spv.empty()) {
+        emitted_spv = Shader::Backend::SPIRV::EmitSPIRV(profile, runtime_info, ir_program, binding);
+        shader_cache.StoreModule(cache_key, emitted_spv);
+        spv = emitted_spv;
+    } else {
+        info.AddBindings(binding);
+    }
     DumpShader(spv, info.pgm_hash, info.stage, perm_idx, "spv");
 
     const auto module = CompileSPV(spv, instance.GetDevice());
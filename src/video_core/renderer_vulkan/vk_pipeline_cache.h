@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include <limits>
+#include <memory>
 #include <tsl/robin_map.h>
 #include "shader_recompiler/profile.h"
 #include "shader_recompiler/recompiler.h"
@@ -10,6 +12,7 @@
 #include "video_core/renderer_vulkan/vk_compute_pipeline.h"
 #include "video_core/renderer_vulkan/vk_graphics_pipeline.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
+#include "video_core/renderer_vulkan/vk_shader_cache.h"
 
 namespace Shader {
 struct Info;
@@ -19,7 +22,6 @@ namespace Vulkan {
 
 class Instance;
 class Scheduler;
-class ShaderCache;
 
 struct Program {
     struct Module {
@@ -54,6 +56,8 @@ public:
 
 private:
     bool RefreshGraphicsKey();
+    void RefreshRenderStateKey();
+    bool IsColorBindingSkipped() const;
     bool RefreshComputeKey();
 
     void DumpShader(std::span<const u32> code, u64 hash, Shader::Stage stage, size_t perm_idx,
@@ -62,12 +66,14 @@ private:
                                    std::span<const u32> code, size_t perm_idx,
                                    Shader::Backend::Bindings& binding);
     Shader::RuntimeInfo BuildRuntimeInfo(Shader::Stage stage);
+    void OnPipelineCreated();
 
 private:
     const Instance& instance;
     Scheduler& scheduler;
     AmdGpu::Liverpool* liverpool;
     DescriptorHeap desc_heap;
+    ShaderCache shader_cache;
     vk::UniquePipelineCache pipeline_cache;
     vk::UniquePipelineLayout pipeline_layout;
     Shader::Profile profile{};
@@ -81,7 +87,11 @@ private:
     std::array<const Shader::Info*, MaxShaderStages> infos{};
     std::array<vk::ShaderModule, MaxShaderStages> modules{};
     GraphicsPipelineKey graphics_key{};
+    GraphicsPipelineKey render_state_key{};
+    u64 render_state_version{std::numeric_limits<u64>::max()};
     u64 compute_key{};
+    u32 num_new_pipelines{};
+    std::unique_ptr<Common::ThreadWorker> compile_worker;
 };
 
 } // namespace Vulkan
@@ -1,12 +1,20 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <span>
+#include <vector>
 #include <boost/container/static_vector.hpp>
 
+#include "common/thread_worker.h"
 #include "shader_recompiler/info.h"
 #include "video_core/buffer_cache/buffer_cache.h"
+#include "video_core/gpu_stats.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_pipeline_common.h"
+#include "video_core/renderer_vulkan/vk_resource_pool.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/texture_cache/texture_cache.h"
 
@@ -22,6 +30,144 @@ Pipeline::Pipeline(const Instance& instance_, Scheduler& scheduler_, DescriptorH
 
 Pipeline::~Pipeline() = default;
 
+void Pipeline::Compile(Common::ThreadWorker* worker, CompileFunc&& func) {
+    auto& stats = VideoCore::GpuStats::Instance();
+    if (!worker) {
+        pipeline = func();
+        is_ready.store(true, std::memory_order_release);
+        stats.Add(VideoCore::Stat::PipelinesCompiled);
+        return;
+    }
+    stats.Add(VideoCore::Stat::PipelinesPending);
+    worker->QueueWork([this, &stats, func = std::move(func)] {
+        pipeline = func();
+        is_ready.store(true, std::memory_order_release);
+        is_ready.notify_all();
+        stats.Sub(VideoCore::Stat::PipelinesPending);
+        stats.Add(VideoCore::Stat::PipelinesCompiled);
+    });
+}
+
+/// Packs the resource referenced by a descriptor write so it can be compared with other writes.
+static DescriptorBindState::Value EncodeDescriptor(const vk::WriteDescriptorSet& write) {
+    DescriptorBindState::Value value{(u64{write.dstBinding} << 32) |
+                                     static_cast<u32>(write.descriptorType)};
+    if (write.pBufferInfo) {
+        value[1] = std::bit_cast<u64>(write.pBufferInfo->buffer);
+        value[2] = write.pBufferInfo->offset;
+        value[3] = write.pBufferInfo->range;
+    } else if (write.pImageInfo) {
+        value[1] = std::bit_cast<u64>(write.pImageInfo->sampler);
+        value[2] = std::bit_cast<u64>(write.pImageInfo->imageView);
+        value[3] = static_cast<u64>(write.pImageInfo->imageLayout);
+    } else if (write.pTexelBufferView) {
+        value[1] = std::bit_cast<u64>(*write.pTexelBufferView);
+    }
+    return value;
+}
+
+/// Copy of descriptor writes together with the infos they point to.
+struct OwnedDescriptorWrites {
+    explicit OwnedDescriptorWrites(std::span<const vk::WriteDescriptorSet> set_writes)
+        : writes{set_writes.begin(), set_writes.end()} {
+        buffer_infos.reserve(writes.size());
+        image_infos.reserve(writes.size());
+        buffer_views.reserve(writes.size());
+        for (auto& write : writes) {
+            if (write.pBufferInfo) {
+                write.pBufferInfo = &buffer_infos.emplace_back(*write.pBufferInfo);
+            } else if (write.pImageInfo) {
+                write.pImageInfo = &image_infos.emplace_back(*write.pImageInfo);
+            } else if (write.pTexelBufferView) {
+                write.pTexelBufferView = &buffer_views.emplace_back(*write.pTexelBufferView);
+            }
+        }
+    }
+
+    std::vector<vk::WriteDescriptorSet> writes;
+    std::vector<vk::DescriptorBufferInfo> buffer_infos;
+    std::vector<vk::DescriptorImageInfo> image_infos;
+    std::vector<vk::BufferView> buffer_views;
+};
+
+/// Records a descriptor binding, which is kept to be replayed when deferred recording starts a
+/// new command chunk.
+template <typename Func>
+static void RecordDescriptorBind(Scheduler& scheduler, DescriptorBindState& state, Func&& func) {
+    if (!scheduler.IsRecordingDeferred()) {
+        scheduler.RecordState(std::forward<Func>(func));
+        return;
+    }
+    auto rebind = std::make_shared<const Command>(std::forward<Func>(func));
+    scheduler.RecordState([rebind](vk::CommandBuffer cmdbuf) { (*rebind)(std::move(cmdbuf)); });
+    state.rebind = std::move(rebind);
+}
+
+void Pipeline::BindDescriptors(vk::PipelineBindPoint bind_point, bool uses_push_descriptors,
+                               DescriptorWrites& set_writes) const {
+    boost::container::small_vector<DescriptorBindState::Value, 16> values;
+    for (const auto& set_write : set_writes) {
+        values.push_back(EncodeDescriptor(set_write));
+    }
+
+    // Descriptor sets stay bound across pipeline changes, consecutive draws with the same
+    // pipeline often reference the same resources.
+    auto& state = scheduler.GetDescriptorBindState(bind_point);
+    const bool is_same_layout = state.layout == *pipeline_layout;
+    if (is_same_layout && std::ranges::equal(values, state.values)) {
+        return;
+    }
+
+    auto& stats = VideoCore::GpuStats::Instance();
+    const vk::PipelineLayout layout = *pipeline_layout;
+    if (uses_push_descriptors) {
+        // The infos referenced by the writes are reused by the next draw.
+        std::span<const vk::WriteDescriptorSet> writes = set_writes;
+        std::shared_ptr<const OwnedDescriptorWrites> owned_writes;
+        if (scheduler.IsRecordingDeferred()) {
+            owned_writes = std::make_shared<const OwnedDescriptorWrites>(set_writes);
+            writes = owned_writes->writes;
+        }
+        RecordDescriptorBind(scheduler, state,
+                             [bind_point, layout, writes, owned_writes](vk::CommandBuffer cmdbuf) {
+                                 cmdbuf.pushDescriptorSetKHR(bind_point, layout, 0, writes);
+                             });
+        stats.Add(VideoCore::Stat::DescriptorWrites, set_writes.size());
+        state.set = VK_NULL_HANDLE;
+    } else {
+        // Only write the descriptors that changed, the rest is copied from the previous set.
+        const auto desc_set = desc_heap.Commit(*desc_layout);
+        DescriptorWrites changed_writes;
+        boost::container::small_vector<vk::CopyDescriptorSet, 16> set_copies;
+        for (size_t i = 0; i < set_writes.size(); ++i) {
+            auto& set_write = set_writes[i];
+            if (is_same_layout && i < state.values.size() && values[i] == state.values[i]) {
+                set_copies.push_back({
+                    .srcSet = state.set,
+                    .srcBinding = set_write.dstBinding,
+                    .srcArrayElement = 0,
+                    .dstSet = desc_set,
+                    .dstBinding = set_write.dstBinding,
+                    .dstArrayElement = 0,
+                    .descriptorCount = 1,
+                });
+                continue;
+            }
+            set_write.dstSet = desc_set;
+            changed_writes.push_back(set_write);
+        }
+        instance.GetDevice().updateDescriptorSets(changed_writes, set_copies);
+        RecordDescriptorBind(scheduler, state,
+                             [bind_point, layout, desc_set](vk::CommandBuffer cmdbuf) {
+                                 cmdbuf.bindDescriptorSets(bind_point, layout, 0, desc_set, {});
+                             });
+        stats.Add(VideoCore::Stat::DescriptorWrites, changed_writes.size());
+        state.set = desc_set;
+    }
+    state.layout = layout;
+    state.values.assign(values.begin(), values.end());
+}
+
 void Pipeline::BindBuffers(VideoCore::BufferCache& buffer_cache,
                            VideoCore::TextureCache& texture_cache, const Shader::Info& stage,
                            Shader::Backend::Bindings& binding, Shader::PushData& push_data,
@@ -3,10 +3,17 @@
 
 #pragma once
 
+#include <atomic>
+
+#include "common/unique_function.h"
 #include "shader_recompiler/backend/bindings.h"
 #include "shader_recompiler/info.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace VideoCore {
 class BufferCache;
 class TextureCache;
@@ -32,6 +39,16 @@ public:
         return *pipeline_layout;
     }
 
+    /// Returns true once the driver has finished compiling the pipeline.
+    bool IsReady() const noexcept {
+        return is_ready.load(std::memory_order_acquire);
+    }
+
+    /// Blocks the calling thread until the pipeline has been compiled.
+    void WaitReady() const noexcept {
+        is_ready.wait(false, std::memory_order_acquire);
+    }
+
     using DescriptorWrites = boost::container::small_vector<vk::WriteDescriptorSet, 16>;
     using BufferBarriers = boost::container::small_vector<vk::BufferMemoryBarrier2, 16>;
 
@@ -43,6 +60,16 @@ public:
     void BindTextures(VideoCore::TextureCache& texture_cache, const Shader::Info& stage,
                       Shader::Backend::Bindings& binding, DescriptorWrites& set_writes) const;
 
+protected:
+    using CompileFunc = Common::UniqueFunction<vk::UniquePipeline>;
+
+    /// Binds the descriptor set, skipping the update if the same descriptors are still bound.
+    void BindDescriptors(vk::PipelineBindPoint bind_point, bool uses_push_descriptors,
+                         DescriptorWrites& set_writes) const;
+
+    /// Creates the driver pipeline inline, or on the worker if one is provided.
+    void Compile(Common::ThreadWorker* worker, CompileFunc&& func);
+
 protected:
     const Instance& instance;
     Scheduler& scheduler;
@@ -50,6 +77,7 @@ protected:
     vk::UniquePipeline pipeline;
     vk::UniquePipelineLayout pipeline_layout;
     vk::UniqueDescriptorSetLayout desc_layout;
+    std::atomic_bool is_ready{};
     static boost::container::static_vector<vk::DescriptorImageInfo, 32> image_infos;
     static boost::container::static_vector<vk::BufferView, 8> buffer_views;
     static boost::container::static_vector<vk::DescriptorBufferInfo, 32> buffer_infos;
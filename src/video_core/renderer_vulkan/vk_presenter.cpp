@@ -572,6 +572,7 @@ Frame* Presenter::PrepareFrameInternal(VideoCore::ImageId image_id, bool is_eop)
         cmdbuf.setViewport(0, viewports);
         cmdbuf.setScissor(0, scissors);
 
+        scheduler.InvalidateDescriptors(vk::PipelineBindPoint::eGraphics);
         cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eGraphics, *pp_pipeline_layout, 0,
                                     set_writes);
         cmdbuf.pushConstants(*pp_pipeline_layout, vk::ShaderStageFlagBits::eFragment, 0,
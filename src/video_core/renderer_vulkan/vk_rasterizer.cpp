@@ -24,6 +24,10 @@ Rasterizer::Rasterizer(const Instance& instance_, Scheduler& scheduler_,
       buffer_cache{instance, scheduler, liverpool_, texture_cache, page_manager},
       texture_cache{instance, scheduler, buffer_cache, page_manager}, liverpool{liverpool_},
       memory{Core::Memory::Instance()}, pipeline_cache{instance, scheduler, liverpool} {
+    scheduler.CreateUploadScheduler();
+    if (Config::isParallelRecordingEnabled()) {
+        scheduler.CreateRecordWorkers();
+    }
     if (!Config::nullGpu()) {
         liverpool->BindRasterizer(this);
     }
@@ -82,7 +86,6 @@ void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
         return;
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
     const auto& regs = liverpool->regs;
     const GraphicsPipeline* pipeline = pipeline_cache.GetGraphicsPipeline();
     if (!pipeline) {
@@ -103,15 +106,20 @@ void Rasterizer::Draw(bool is_indexed, u32 index_offset) {
     UpdateDynamicState(*pipeline);
 
     const auto [vertex_offset, instance_offset] = vs_info.GetDrawOffsets();
+    const u32 num_instances = regs.num_instances.NumInstances();
 
     if (is_indexed) {
-        cmdbuf.drawIndexed(num_indices, regs.num_instances.NumInstances(), 0, s32(vertex_offset),
-                           instance_offset);
+        scheduler.Record([num_indices, num_instances, vertex_offset = s32(vertex_offset),
+                          instance_offset = instance_offset](vk::CommandBuffer cmdbuf) {
+            cmdbuf.drawIndexed(num_indices, num_instances, 0, vertex_offset, instance_offset);
+        });
     } else {
         const u32 num_vertices =
             regs.primitive_type == AmdGpu::PrimitiveType::RectList ? 4 : regs.num_indices;
-        cmdbuf.draw(num_vertices, regs.num_instances.NumInstances(), vertex_offset,
-                    instance_offset);
+        scheduler.Record([num_vertices, num_instances, vertex_offset = vertex_offset,
+                          instance_offset = instance_offset](vk::CommandBuffer cmdbuf) {
+            cmdbuf.draw(num_vertices, num_instances, vertex_offset, instance_offset);
+        });
     }
 }
 
@@ -156,36 +164,41 @@ void Rasterizer::DrawIndirect(bool is_indexed, VAddr arg_address, u32 offset, u3
     // We can safely ignore both SGPR UD indices and results of fetch shader parsing, as vertex and
     // instance offsets will be automatically applied by Vulkan from indirect args buffer.
 
-    const auto cmdbuf = scheduler.CommandBuffer();
+    const vk::Buffer args_buffer = buffer->Handle();
+    const u32 args_offset = base;
+    const vk::Buffer count_handle = count_buffer ? count_buffer->Handle() : vk::Buffer{};
     if (is_indexed) {
         static_assert(sizeof(VkDrawIndexedIndirectCommand) ==
                       AmdGpu::Liverpool::DrawIndexedIndirectArgsSize);
 
-        if (count_address != 0) {
-            cmdbuf.drawIndexedIndirectCount(buffer->Handle(), base, count_buffer->Handle(),
-                                            count_base, max_count,
-                                            AmdGpu::Liverpool::DrawIndexedIndirectArgsSize);
-        } else {
-            cmdbuf.drawIndexedIndirect(buffer->Handle(), base, max_count,
-                                       AmdGpu::Liverpool::DrawIndexedIndirectArgsSize);
-        }
+        scheduler.Record([=](vk::CommandBuffer cmdbuf) {
+            if (count_handle) {
+                cmdbuf.drawIndexedIndirectCount(args_buffer, args_offset, count_handle, count_base,
+                                                max_count,
+                                                AmdGpu::Liverpool::DrawIndexedIndirectArgsSize);
+            } else {
+                cmdbuf.drawIndexedIndirect(args_buffer, args_offset, max_count,
+                                           AmdGpu::Liverpool::DrawIndexedIndirectArgsSize);
+            }
+        });
     } else {
         static_assert(sizeof(VkDrawIndirectCommand) == AmdGpu::Liverpool::DrawIndirectArgsSize);
 
-        if (count_address != 0) {
-            cmdbuf.drawIndirectCount(buffer->Handle(), base, count_buffer->Handle(), count_base,
-                                     max_count, AmdGpu::Liverpool::DrawIndirectArgsSize);
-        } else {
-            cmdbuf.drawIndirect(buffer->Handle(), base, max_count,
-                                AmdGpu::Liverpool::DrawIndirectArgsSize);
-        }
+        scheduler.Record([=](vk::CommandBuffer cmdbuf) {
+            if (count_handle) {
+                cmdbuf.drawIndirectCount(args_buffer, args_offset, count_handle, count_base,
+                                         max_count, AmdGpu::Liverpool::DrawIndirectArgsSize);
+            } else {
+                cmdbuf.drawIndirect(args_buffer, args_offset, max_count,
+                                    AmdGpu::Liverpool::DrawIndirectArgsSize);
+            }
+        });
     }
 }
 
 void Rasterizer::DispatchDirect() {
     RENDERER_TRACE;
 
-    const auto cmdbuf = scheduler.CommandBuffer();
     const auto& cs_program = liverpool->regs.cs_program;
     const ComputePipeline* pipeline = pipeline_cache.GetComputePipeline();
     if (!pipeline) {
@@ -202,14 +215,17 @@ void Rasterizer::DispatchDirect() {
     }
 
     scheduler.EndRendering();
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->Handle());
-    cmdbuf.dispatch(cs_program.dim_x, cs_program.dim_y, cs_program.dim_z);
+    scheduler.Record([handle = pipeline->Handle(), dim_x = cs_program.dim_x,
+                      dim_y = cs_program.dim_y,
+                      dim_z = cs_program.dim_z](vk::CommandBuffer cmdbuf) {
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, handle);
+        cmdbuf.dispatch(dim_x, dim_y, dim_z);
+    });
 }
 
 void Rasterizer::DispatchIndirect(VAddr address, u32 offset, u32 size) {
     RENDERER_TRACE;
 
-    const auto cmdbuf = scheduler.CommandBuffer();
     const auto& cs_program = liverpool->regs.cs_program;
     const ComputePipeline* pipeline = pipeline_cache.GetComputePipeline();
     if (!pipeline) {
@@ -226,18 +242,52 @@ void Rasterizer::DispatchIndirect(VAddr address, u32 offset, u32 size) {
     }
 
     scheduler.EndRendering();
-    cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, pipeline->Handle());
     const auto [buffer, base] = buffer_cache.ObtainBuffer(address + offset, size, false);
-    cmdbuf.dispatchIndirect(buffer->Handle(), base);
+    scheduler.Record([handle = pipeline->Handle(), args_buffer = buffer->Handle(),
+                      args_offset = base](vk::CommandBuffer cmdbuf) {
+        cmdbuf.bindPipeline(vk::PipelineBindPoint::eCompute, handle);
+        cmdbuf.dispatchIndirect(args_buffer, args_offset);
+    });
 }
 
 u64 Rasterizer::Flush() {
     const u64 current_tick = scheduler.CurrentTick();
     SubmitInfo info{};
     scheduler.Flush(info);
+    EnforceMemoryBudget();
     return current_tick;
 }
 
+void Rasterizer::EnforceMemoryBudget() {
+    // Resources are only considered for eviction when unused for this many submissions.
+    static constexpr u64 MinEvictionAge = 128;
+
+    const u32 budget_percent = Config::getVramBudgetPercent();
+    if (budget_percent == 0) {
+        return;
+    }
+    // Memory of evicted resources is released once the GPU is done with them, wait for that before
+    // looking at the budget again.
+    if (!scheduler.IsFree(last_eviction_tick)) {
+        return;
+    }
+    const auto [usage, budget] = instance.GetDeviceLocalMemoryBudget();
+    const u64 target = budget / 100 * std::min(budget_percent, 100u);
+    if (usage <= target) {
+        return;
+    }
+
+    // Free some headroom as well so that the next few allocations do not trigger another pass.
+    const u64 bytes_to_free = usage - target + target / 16;
+    LOG_INFO(Render_Vulkan, "Device memory usage {} MiB exceeds budget {} MiB, evicting {} MiB",
+             usage >> 20, target >> 20, bytes_to_free >> 20);
+    const u64 image_bytes = texture_cache.EvictImages(bytes_to_free, MinEvictionAge);
+    if (image_bytes < bytes_to_free) {
+        buffer_cache.EvictBuffers(bytes_to_free - image_bytes, MinEvictionAge);
+    }
+    last_eviction_tick = scheduler.CurrentTick();
+}
+
 void Rasterizer::Finish() {
     scheduler.Finish();
 }
@@ -403,8 +453,9 @@ void Rasterizer::UpdateDynamicState(const GraphicsPipeline& pipeline) {
     UpdateViewportScissorState();
 
     auto& regs = liverpool->regs;
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.setBlendConstants(&regs.blend_constants.red);
+    scheduler.RecordState([blend_constants = regs.blend_constants](vk::CommandBuffer cmdbuf) {
+        cmdbuf.setBlendConstants(&blend_constants.red);
+    });
 
     if (instance.IsColorWriteEnableSupported()) {
         const auto& write_masks = pipeline.GetWriteMasks();
@@ -412,43 +463,58 @@ void Rasterizer::UpdateDynamicState(const GraphicsPipeline& pipeline) {
         std::transform(write_masks.cbegin(), write_masks.cend(), write_ens.begin(),
                        [](auto in) { return in ? vk::True : vk::False; });
 
-        cmdbuf.setColorWriteEnableEXT(write_ens);
-        cmdbuf.setColorWriteMaskEXT(0, write_masks);
+        scheduler.RecordState([write_ens, write_masks](vk::CommandBuffer cmdbuf) {
+            cmdbuf.setColorWriteEnableEXT(write_ens);
+            cmdbuf.setColorWriteMaskEXT(0, write_masks);
+        });
     }
     if (regs.depth_control.depth_bounds_enable) {
-        cmdbuf.setDepthBounds(regs.depth_bounds_min, regs.depth_bounds_max);
+        scheduler.RecordState([min_bounds = regs.depth_bounds_min,
+                               max_bounds = regs.depth_bounds_max](vk::CommandBuffer cmdbuf) {
+            cmdbuf.setDepthBounds(min_bounds, max_bounds);
+        });
     }
     if (regs.polygon_control.enable_polygon_offset_front) {
-        cmdbuf.setDepthBias(regs.poly_offset.front_offset, regs.poly_offset.depth_bias,
-                            regs.poly_offset.front_scale / 16.f);
+        scheduler.RecordState([offset = regs.poly_offset.front_offset,
+                               bias = regs.poly_offset.depth_bias,
+                               scale = regs.poly_offset.front_scale](vk::CommandBuffer cmdbuf) {
+            cmdbuf.setDepthBias(offset, bias, scale / 16.f);
+        });
     } else if (regs.polygon_control.enable_polygon_offset_back) {
-        cmdbuf.setDepthBias(regs.poly_offset.back_offset, regs.poly_offset.depth_bias,
-                            regs.poly_offset.back_scale / 16.f);
+        scheduler.RecordState([offset = regs.poly_offset.back_offset,
+                               bias = regs.poly_offset.depth_bias,
+                               scale = regs.poly_offset.back_scale](vk::CommandBuffer cmdbuf) {
+            cmdbuf.setDepthBias(offset, bias, scale / 16.f);
+        });
     }
     if (regs.depth_control.stencil_enable) {
-        const auto front = regs.stencil_ref_front;
-        const auto back = regs.stencil_ref_back;
-        if (front.stencil_test_val == back.stencil_test_val) {
-            cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eFrontAndBack,
-                                       front.stencil_test_val);
-        } else {
-            cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eFront, front.stencil_test_val);
-            cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eBack, back.stencil_test_val);
-        }
-        if (front.stencil_write_mask == back.stencil_write_mask) {
-            cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eFrontAndBack,
-                                       front.stencil_write_mask);
-        } else {
-            cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eFront, front.stencil_write_mask);
-            cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eBack, back.stencil_write_mask);
-        }
-        if (front.stencil_mask == back.stencil_mask) {
-            cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eFrontAndBack,
-                                         front.stencil_mask);
-        } else {
-            cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eFront, front.stencil_mask);
-            cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eBack, back.stencil_mask);
-        }
+        scheduler.RecordState([front = regs.stencil_ref_front,
+                               back = regs.stencil_ref_back](vk::CommandBuffer cmdbuf) {
+            if (front.stencil_test_val == back.stencil_test_val) {
+                cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eFrontAndBack,
+                                           front.stencil_test_val);
+            } else {
+                cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eFront,
+                                           front.stencil_test_val);
+                cmdbuf.setStencilReference(vk::StencilFaceFlagBits::eBack, back.stencil_test_val);
+            }
+            if (front.stencil_write_mask == back.stencil_write_mask) {
+                cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eFrontAndBack,
+                                           front.stencil_write_mask);
+            } else {
+                cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eFront,
+                                           front.stencil_write_mask);
+                cmdbuf.setStencilWriteMask(vk::StencilFaceFlagBits::eBack,
+                                           back.stencil_write_mask);
+            }
+            if (front.stencil_mask == back.stencil_mask) {
+                cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eFrontAndBack,
+                                             front.stencil_mask);
+            } else {
+                cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eFront, front.stencil_mask);
+                cmdbuf.setStencilCompareMask(vk::StencilFaceFlagBits::eBack, back.stencil_mask);
+            }
+        });
     }
 }
 
@@ -527,16 +593,18 @@ void Rasterizer::UpdateViewportScissorState() {
         });
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.setViewport(0, viewports);
-    cmdbuf.setScissor(0, scissors);
+    scheduler.RecordState([viewports, scissors](vk::CommandBuffer cmdbuf) {
+        cmdbuf.setViewport(0, viewports);
+        cmdbuf.setScissor(0, scissors);
+    });
 }
 
 void Rasterizer::UpdateDepthStencilState() {
     auto& depth = liverpool->regs.depth_control;
 
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.setDepthBoundsTestEnable(depth.depth_bounds_enable);
+    scheduler.RecordState([enable = bool(depth.depth_bounds_enable)](vk::CommandBuffer cmdbuf) {
+        cmdbuf.setDepthBoundsTestEnable(enable);
+    });
 }
 
 void Rasterizer::ScopeMarkerBegin(const std::string_view& str) {
@@ -544,9 +612,10 @@ void Rasterizer::ScopeMarkerBegin(const std::string_view& str) {
         return;
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.beginDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
-        .pLabelName = str.data(),
+    scheduler.Record([label = std::string{str}](vk::CommandBuffer cmdbuf) {
+        cmdbuf.beginDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
+            .pLabelName = label.c_str(),
+        });
     });
 }
 
@@ -555,8 +624,7 @@ void Rasterizer::ScopeMarkerEnd() {
         return;
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.endDebugUtilsLabelEXT();
+    scheduler.Record([](vk::CommandBuffer cmdbuf) { cmdbuf.endDebugUtilsLabelEXT(); });
 }
 
 void Rasterizer::ScopedMarkerInsert(const std::string_view& str) {
@@ -564,9 +632,10 @@ void Rasterizer::ScopedMarkerInsert(const std::string_view& str) {
         return;
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.insertDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
-        .pLabelName = str.data(),
+    scheduler.Record([label = std::string{str}](vk::CommandBuffer cmdbuf) {
+        cmdbuf.insertDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
+            .pLabelName = label.c_str(),
+        });
     });
 }
 
@@ -575,12 +644,13 @@ void Rasterizer::ScopedMarkerInsertColor(const std::string_view& str, const u32
         return;
     }
 
-    const auto cmdbuf = scheduler.CommandBuffer();
-    cmdbuf.insertDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
-        .pLabelName = str.data(),
-        .color = std::array<f32, 4>(
-            {(f32)((color >> 16) & 0xff) / 255.0f, (f32)((color >> 8) & 0xff) / 255.0f,
-             (f32)(color & 0xff) / 255.0f, (f32)((color >> 24) & 0xff) / 255.0f})});
+    scheduler.Record([label = std::string{str}, color](vk::CommandBuffer cmdbuf) {
+        cmdbuf.insertDebugUtilsLabelEXT(vk::DebugUtilsLabelEXT{
+            .pLabelName = label.c_str(),
+            .color = std::array<f32, 4>(
+                {(f32)((color >> 16) & 0xff) / 255.0f, (f32)((color >> 8) & 0xff) / 255.0f,
+                 (f32)(color & 0xff) / 255.0f, (f32)((color >> 24) & 0xff) / 255.0f})});
+    });
 }
 
 } // namespace Vulkan
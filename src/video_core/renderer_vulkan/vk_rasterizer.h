@@ -63,6 +63,9 @@ private:
 
     bool FilterDraw();
 
+    /// Evicts least recently used images and buffers when device memory exceeds the budget.
+    void EnforceMemoryBudget();
+
 private:
     const Instance& instance;
     Scheduler& scheduler;
@@ -72,6 +75,7 @@ private:
     AmdGpu::Liverpool* liverpool;
     Core::MemoryManager* memory;
     PipelineCache pipeline_cache;
+    u64 last_eviction_tick{};
 };
 
 } // namespace Vulkan
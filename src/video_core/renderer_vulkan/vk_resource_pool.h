@@ -4,6 +4,7 @@
 #pragma once
 
 #include <deque>
+#include <optional>
 #include <vector>
 #include <boost/container/static_vector.hpp>
 #include <tsl/robin_map.h>
@@ -51,7 +52,9 @@ protected:
 
 class CommandPool final : public ResourcePool {
 public:
-    explicit CommandPool(const Instance& instance, MasterSemaphore* master_semaphore);
+    /// Creates a pool for the graphics queue family unless another family is provided.
+    explicit CommandPool(const Instance& instance, MasterSemaphore* master_semaphore,
+                         std::optional<u32> queue_family_index = std::nullopt);
     ~CommandPool() override;
 
     void Allocate(std::size_t begin, std::size_t end) override;
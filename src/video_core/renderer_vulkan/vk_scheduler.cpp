@@ -1,17 +1,28 @@
 // SPDX-FileCopyrightText: Copyright 2019 yuzu Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <iterator>
 #include <mutex>
+#include <thread>
+#include <boost/container/small_vector.hpp>
 #include "common/assert.h"
 #include "common/debug.h"
+#include "common/thread_worker.h"
 #include "imgui/renderer/texture_manager.h"
+#include "video_core/gpu_stats.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/renderer_vulkan/vk_upload_scheduler.h"
 
 namespace Vulkan {
 
 std::mutex Scheduler::submit_mutex;
 
+// Chunks are only handed to the workers at render pass boundaries once they hold this many
+// commands, so that small passes do not each pay for a command buffer of their own.
+constexpr size_t MinChunkCommands = 256;
+
 Scheduler::Scheduler(const Instance& instance)
     : instance{instance}, master_semaphore{instance}, command_pool{instance, &master_semaphore} {
     profiler_scope = reinterpret_cast<tracy::VkCtxScope*>(std::malloc(sizeof(tracy::VkCtxScope)));
@@ -22,35 +33,59 @@ Scheduler::~Scheduler() {
     std::free(profiler_scope);
 }
 
+void Scheduler::CreateUploadScheduler() {
+    upload_scheduler = std::make_unique<UploadScheduler>(instance, &master_semaphore);
+}
+
+void Scheduler::CreateRecordWorkers() {
+    // Command pools are externally synchronized, every worker takes one for each chunk it records.
+    const u32 num_workers = std::clamp(std::thread::hardware_concurrency() / 4, 1U, 4U);
+    for (u32 i = 0; i < num_workers; ++i) {
+        const auto& pool = record_pools.emplace_back(
+            std::make_unique<CommandPool>(instance, &master_semaphore));
+        free_record_pools.push_back(pool.get());
+    }
+    record_worker = std::make_unique<Common::ThreadWorker>(num_workers, "shadPS4:Recorder");
+
+    // The GPU zone cannot span the command buffers of a submission.
+    if (instance.GetProfilerContext()) {
+        profiler_scope->~VkCtxScope();
+    }
+    chunks.push_back({.cmdbuf = current_cmdbuf});
+}
+
 void Scheduler::BeginRendering(const RenderState& new_state) {
     if (is_rendering && render_state == new_state) {
         return;
     }
     EndRendering();
+    // Render pass boundaries are where chunks are handed to the workers.
+    if (open_chunk && open_chunk->commands.size() >= MinChunkCommands) {
+        CloseChunk();
+    }
     is_rendering = true;
     render_state = new_state;
 
-    const auto witdh =
-        render_state.width != std::numeric_limits<u32>::max() ? render_state.width : 1;
-    const auto height =
-        render_state.height != std::numeric_limits<u32>::max() ? render_state.height : 1;
-
-    const vk::RenderingInfo rendering_info = {
-        .renderArea =
-            {
-                .offset = {0, 0},
-                .extent = {witdh, height},
-            },
-        .layerCount = 1,
-        .colorAttachmentCount = render_state.num_color_attachments,
-        .pColorAttachments = render_state.num_color_attachments > 0
-                                 ? render_state.color_attachments.data()
-                                 : nullptr,
-        .pDepthAttachment = render_state.has_depth ? &render_state.depth_attachment : nullptr,
-        .pStencilAttachment = render_state.has_stencil ? &render_state.depth_attachment : nullptr,
-    };
+    Record([state = render_state](vk::CommandBuffer cmdbuf) {
+        const auto witdh = state.width != std::numeric_limits<u32>::max() ? state.width : 1;
+        const auto height = state.height != std::numeric_limits<u32>::max() ? state.height : 1;
 
-    current_cmdbuf.beginRendering(rendering_info);
+        const vk::RenderingInfo rendering_info = {
+            .renderArea =
+                {
+                    .offset = {0, 0},
+                    .extent = {witdh, height},
+                },
+            .layerCount = 1,
+            .colorAttachmentCount = state.num_color_attachments,
+            .pColorAttachments =
+                state.num_color_attachments > 0 ? state.color_attachments.data() : nullptr,
+            .pDepthAttachment = state.has_depth ? &state.depth_attachment : nullptr,
+            .pStencilAttachment = state.has_stencil ? &state.depth_attachment : nullptr,
+        };
+
+        cmdbuf.beginRendering(rendering_info);
+    });
 }
 
 void Scheduler::EndRendering() {
@@ -58,9 +93,100 @@ void Scheduler::EndRendering() {
         return;
     }
     is_rendering = false;
+    if (open_chunk) {
+        // Ending the render pass may close the chunk, state for the next draw goes to the next one.
+        open_chunk->commands.emplace_back([](vk::CommandBuffer cmdbuf) { cmdbuf.endRendering(); });
+        return;
+    }
     current_cmdbuf.endRendering();
 }
 
+void Scheduler::RecordDeferred(Command&& command, bool is_state) {
+    if (is_state) {
+        state_commands.push_back(std::move(command));
+        return;
+    }
+    if (!open_chunk) {
+        OpenChunk();
+    }
+    auto& commands = open_chunk->commands;
+    std::ranges::move(state_commands, std::back_inserter(commands));
+    state_commands.clear();
+    commands.push_back(std::move(command));
+}
+
+void Scheduler::OpenChunk() {
+    if (current_cmdbuf) {
+        const auto end_result = current_cmdbuf.end();
+        ASSERT_MSG(end_result == vk::Result::eSuccess, "Failed to end command buffer: {}",
+                   vk::to_string(end_result));
+        current_cmdbuf = VK_NULL_HANDLE;
+    }
+    open_chunk = &chunks.emplace_back();
+
+    // Bound descriptors do not carry over to another command buffer, but draws may rely on the
+    // ones bound by previous draws.
+    for (const auto& state : descriptor_states) {
+        if (state.layout && state.rebind) {
+            open_chunk->commands.emplace_back([rebind = state.rebind](vk::CommandBuffer cmdbuf) {
+                (*rebind)(std::move(cmdbuf));
+            });
+        }
+    }
+}
+
+void Scheduler::CloseChunk() {
+    CommandChunk& chunk = *std::exchange(open_chunk, nullptr);
+    record_worker->QueueWork([this, &chunk] { RecordChunk(chunk); });
+    VideoCore::GpuStats::Instance().Add(VideoCore::Stat::CommandChunks);
+}
+
+void Scheduler::SplitChunk() {
+    if (open_chunk) {
+        EndRendering();
+        CloseChunk();
+    }
+    if (current_cmdbuf) {
+        return;
+    }
+    const vk::CommandBufferBeginInfo begin_info = {
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+    };
+    current_cmdbuf = command_pool.Commit();
+    const auto begin_result = current_cmdbuf.begin(begin_info);
+    ASSERT_MSG(begin_result == vk::Result::eSuccess, "Failed to begin command buffer: {}",
+               vk::to_string(begin_result));
+    chunks.push_back({.cmdbuf = current_cmdbuf});
+}
+
+void Scheduler::RecordChunk(CommandChunk& chunk) {
+    CommandPool* pool;
+    {
+        std::scoped_lock lk{record_pool_mutex};
+        pool = free_record_pools.back();
+        free_record_pools.pop_back();
+    }
+
+    const vk::CommandBufferBeginInfo begin_info = {
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+    };
+    const vk::CommandBuffer cmdbuf = pool->Commit();
+    const auto begin_result = cmdbuf.begin(begin_info);
+    ASSERT_MSG(begin_result == vk::Result::eSuccess, "Failed to begin command buffer: {}",
+               vk::to_string(begin_result));
+    for (const auto& command : chunk.commands) {
+        command(vk::CommandBuffer{cmdbuf});
+    }
+    const auto end_result = cmdbuf.end();
+    ASSERT_MSG(end_result == vk::Result::eSuccess, "Failed to end command buffer: {}",
+               vk::to_string(end_result));
+    chunk.commands.clear();
+    chunk.cmdbuf = cmdbuf;
+
+    std::scoped_lock lk{record_pool_mutex};
+    free_record_pools.push_back(pool);
+}
+
 void Scheduler::Flush(SubmitInfo& info) {
     // When flushing, we only send data to the driver; no waiting is necessary.
     SubmitExecution(info);
@@ -84,6 +210,16 @@ void Scheduler::Wait(u64 tick) {
 }
 
 void Scheduler::AllocateWorkerCommandBuffers() {
+    for (auto& state : descriptor_states) {
+        state.layout = VK_NULL_HANDLE;
+        state.rebind.reset();
+    }
+    if (record_worker) {
+        // Command buffers for directly recorded commands are allocated between chunks on demand.
+        current_cmdbuf = VK_NULL_HANDLE;
+        return;
+    }
+
     const vk::CommandBufferBeginInfo begin_info = {
         .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
     };
@@ -103,26 +239,53 @@ void Scheduler::AllocateWorkerCommandBuffers() {
 
 void Scheduler::SubmitExecution(SubmitInfo& info) {
     std::scoped_lock lk{submit_mutex};
+    EndRendering();
+    if (record_worker) {
+        if (open_chunk) {
+            CloseChunk();
+        }
+        record_worker->WaitForRequests();
+    }
+
+    // Uploads batched during this tick have to execute before the graphics commands.
+    const vk::CommandBuffer upload_cmdbuf =
+        upload_scheduler ? upload_scheduler->Flush(info) : vk::CommandBuffer{};
     const u64 signal_value = master_semaphore.NextTick();
 
     auto* profiler_ctx = instance.GetProfilerContext();
     if (profiler_ctx) {
-        profiler_scope->~VkCtxScope();
-        TracyVkCollect(profiler_ctx, current_cmdbuf);
+        if (!record_worker) {
+            profiler_scope->~VkCtxScope();
+        }
+        TracyVkCollect(profiler_ctx, CommandBuffer());
     }
 
-    EndRendering();
-    auto end_result = current_cmdbuf.end();
-    ASSERT_MSG(end_result == vk::Result::eSuccess, "Failed to end command buffer: {}",
-               vk::to_string(end_result));
+    if (current_cmdbuf) {
+        auto end_result = current_cmdbuf.end();
+        ASSERT_MSG(end_result == vk::Result::eSuccess, "Failed to end command buffer: {}",
+                   vk::to_string(end_result));
+    }
 
     const vk::Semaphore timeline = master_semaphore.Handle();
     info.AddSignal(timeline, signal_value);
 
-    static constexpr std::array<vk::PipelineStageFlags, 2> wait_stage_masks = {
+    static constexpr std::array<vk::PipelineStageFlags, 3> wait_stage_masks = {
         vk::PipelineStageFlagBits::eAllCommands,
         vk::PipelineStageFlagBits::eColorAttachmentOutput,
+        vk::PipelineStageFlagBits::eAllCommands,
     };
+    // Chunks recorded by the workers execute in the order their commands were recorded.
+    boost::container::small_vector<vk::CommandBuffer, 16> cmdbufs;
+    if (upload_cmdbuf) {
+        cmdbufs.push_back(upload_cmdbuf);
+    }
+    if (record_worker) {
+        std::ranges::transform(chunks, std::back_inserter(cmdbufs),
+                               [](const CommandChunk& chunk) { return chunk.cmdbuf; });
+        chunks.clear();
+    } else {
+        cmdbufs.push_back(current_cmdbuf);
+    }
 
     const vk::TimelineSemaphoreSubmitInfo timeline_si = {
         .waitSemaphoreValueCount = static_cast<u32>(info.wait_ticks.size()),
@@ -136,8 +299,8 @@ void Scheduler::SubmitExecution(SubmitInfo& info) {
         .waitSemaphoreCount = static_cast<u32>(info.wait_semas.size()),
         .pWaitSemaphores = info.wait_semas.data(),
         .pWaitDstStageMask = wait_stage_masks.data(),
-        .commandBufferCount = 1U,
-        .pCommandBuffers = &current_cmdbuf,
+        .commandBufferCount = static_cast<u32>(cmdbufs.size()),
+        .pCommandBuffers = cmdbufs.data(),
         .signalSemaphoreCount = static_cast<u32>(info.signal_semas.size()),
         .pSignalSemaphores = info.signal_semas.data(),
     };
@@ -3,16 +3,28 @@
 
 #pragma once
 
+#include <array>
 #include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
 #include <boost/container/static_vector.hpp>
 #include "common/types.h"
 #include "common/unique_function.h"
 #include "video_core/renderer_vulkan/vk_master_semaphore.h"
 #include "video_core/renderer_vulkan/vk_resource_pool.h"
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace Vulkan {
 
 class Instance;
+class UploadScheduler;
+
+using Command = Common::UniqueFunction<void, vk::CommandBuffer>;
 
 struct RenderState {
     std::array<vk::RenderingAttachmentInfo, 8> color_attachments{};
@@ -30,6 +42,17 @@ struct RenderState {
     }
 };
 
+/// Descriptors bound to set 0 of a pipeline bind point in the current command buffer.
+struct DescriptorBindState {
+    using Value = std::array<u64, 4>;
+
+    vk::PipelineLayout layout{};
+    vk::DescriptorSet set{}; ///< Null when the descriptors were pushed.
+    std::vector<Value> values;
+    std::shared_ptr<const Command> rebind; ///< Binds the same descriptors again when recording
+                                           ///< is deferred and a new command chunk starts.
+};
+
 struct SubmitInfo {
     boost::container::static_vector<vk::Semaphore, 3> wait_semas;
     boost::container::static_vector<u64, 3> wait_ticks;
@@ -78,11 +101,40 @@ public:
         return render_state;
     }
 
-    /// Returns the current command buffer.
-    vk::CommandBuffer CommandBuffer() const {
+    /// Returns the command buffer for commands recorded directly by the calling thread.
+    vk::CommandBuffer CommandBuffer() {
+        if (open_chunk || !current_cmdbuf) [[unlikely]] {
+            SplitChunk();
+        }
         return current_cmdbuf;
     }
 
+    /// Records a command in order with every other command of the scheduler.
+    template <typename Func>
+    void Record(Func&& func) {
+        if (!record_worker) {
+            func(current_cmdbuf);
+            return;
+        }
+        RecordDeferred(Command{std::forward<Func>(func)}, false);
+    }
+
+    /// Records a command that only binds state for the next draw or dispatch. When recording is
+    /// deferred it may execute after commands that were recorded directly for the same draw.
+    template <typename Func>
+    void RecordState(Func&& func) {
+        if (!record_worker) {
+            func(current_cmdbuf);
+            return;
+        }
+        RecordDeferred(Command{std::forward<Func>(func)}, true);
+    }
+
+    /// Returns true when recorded commands are executed later on the recording workers.
+    [[nodiscard]] bool IsRecordingDeferred() const noexcept {
+        return record_worker != nullptr;
+    }
+
     /// Returns the current command buffer tick.
     [[nodiscard]] u64 CurrentTick() const noexcept {
         return master_semaphore.CurrentTick();
@@ -98,6 +150,29 @@ public:
         return &master_semaphore;
     }
 
+    /// Enables batching of uploads ahead of the command buffers of this scheduler.
+    void CreateUploadScheduler();
+
+    /// Moves recording of the commands passed to Record and RecordState to worker threads.
+    void CreateRecordWorkers();
+
+    /// Returns the upload scheduler, if uploads are batched for this scheduler.
+    [[nodiscard]] UploadScheduler* GetUploadScheduler() noexcept {
+        return upload_scheduler.get();
+    }
+
+    /// Returns the descriptors last bound to the bind point in the current command buffer.
+    [[nodiscard]] DescriptorBindState& GetDescriptorBindState(vk::PipelineBindPoint bind_point) {
+        return descriptor_states[static_cast<size_t>(bind_point)];
+    }
+
+    /// Must be called after binding descriptors to the bind point without a Pipeline.
+    void InvalidateDescriptors(vk::PipelineBindPoint bind_point) {
+        auto& state = descriptor_states[static_cast<size_t>(bind_point)];
+        state.layout = VK_NULL_HANDLE;
+        state.rebind.reset();
+    }
+
     /// Defers an operation until the gpu has reached the current cpu tick.
     void DeferOperation(Common::UniqueFunction<void>&& func) {
         pending_ops.emplace(std::move(func), CurrentTick());
@@ -106,14 +181,32 @@ public:
     static std::mutex submit_mutex;
 
 private:
+    /// Deferred commands between two directly recorded commands, recorded by one worker into a
+    /// command buffer of its own. Chunks without commands hold a directly recorded command buffer.
+    struct CommandChunk {
+        std::vector<Command> commands;
+        vk::CommandBuffer cmdbuf;
+    };
+
     void AllocateWorkerCommandBuffers();
 
     void SubmitExecution(SubmitInfo& info);
 
+    void RecordDeferred(Command&& command, bool is_state);
+
+    void OpenChunk();
+
+    void CloseChunk();
+
+    void SplitChunk();
+
+    void RecordChunk(CommandChunk& chunk);
+
 private:
     const Instance& instance;
     MasterSemaphore master_semaphore;
     CommandPool command_pool;
+    std::unique_ptr<UploadScheduler> upload_scheduler;
     vk::CommandBuffer current_cmdbuf;
     std::condition_variable_any event_cv;
     struct PendingOp {
@@ -122,6 +215,14 @@ private:
     };
     std::queue<PendingOp> pending_ops;
     RenderState render_state;
+    std::array<DescriptorBindState, 2> descriptor_states;
+    std::vector<std::unique_ptr<CommandPool>> record_pools;
+    std::vector<CommandPool*> free_record_pools;
+    std::mutex record_pool_mutex;
+    std::deque<CommandChunk> chunks;
+    CommandChunk* open_chunk{};
+    std::vector<Command> state_commands;
+    std::unique_ptr<Common::ThreadWorker> record_worker;
     bool is_rendering = false;
     tracy::VkCtxScope* profiler_scope{};
 };
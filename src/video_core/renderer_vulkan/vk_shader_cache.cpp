@@ -0,0 +1,241 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstring>
+#include <xxhash.h>
+
+#include "common/config.h"
+#include "common/elf_info.h"
+#include "common/logging/log.h"
+#include "common/path_util.h"
+#include "common/scm_rev.h"
+#include "shader_recompiler/recompiler.h"
+#include "shader_recompiler/specialization.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_shader_cache.h"
+
+namespace Vulkan {
+
+using namespace Common::FS;
+
+constexpr u32 CacheMagic = 0x43535053; // "SPSC"
+constexpr u32 CacheFormatVersion = 1;
+
+constexpr auto ModuleFileName = "modules.bin";
+constexpr auto PipelineFileName = "pipelines.bin";
+
+template <typename Container>
+static void HashElements(XXH3_state_t* state, const Container& container) {
+    if (!container.empty()) {
+        XXH3_64bits_update(state, container.data(),
+                           container.size() * sizeof(typename Container::value_type));
+    }
+}
+
+template <typename T>
+static void HashObject(XXH3_state_t* state, const T& object) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    XXH3_64bits_update(state, &object, sizeof(T));
+}
+
+ShaderCache::ShaderCache(const Instance& instance) {
+    if (!Config::isShaderCacheEnabled()) {
+        return;
+    }
+    if (!Config::getDisabledShaderPasses().empty()) {
+        // Cached modules do not record which passes produced them.
+        LOG_WARNING(Render_Vulkan, "Persistent shader cache is disabled with shader passes off");
+        return;
+    }
+    const auto serial = Common::ElfInfo::Instance().GameSerial();
+    if (serial.empty()) {
+        LOG_WARNING(Render_Vulkan, "Unknown game serial, persistent shader cache is disabled");
+        return;
+    }
+
+    cache_dir = GetUserPath(PathType::ShaderDir) / "cache" / serial;
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir, ec);
+    if (ec) {
+        LOG_ERROR(Render_Vulkan, "Failed to create shader cache directory: {}", ec.message());
+        return;
+    }
+
+    header = FileHeader{
+        .magic = CacheMagic,
+        .format_version = CacheFormatVersion,
+        .recompiler_version = Shader::RecompilerVersion,
+        .vendor_id = instance.GetVendorID(),
+        .device_id = instance.GetDeviceID(),
+        .driver_version = instance.GetDriverVersion(),
+        .build_hash = XXH3_64bits(Common::g_scm_rev, std::strlen(Common::g_scm_rev)),
+        .pipeline_cache_uuid = instance.GetPipelineCacheUUID(),
+    };
+    enabled = true;
+    LoadModules();
+}
+
+ShaderCache::~ShaderCache() = default;
+
+u64 ShaderCache::ComputeModuleKey(u64 pgm_hash, const Shader::StageSpecialization& spec) {
+    XXH3_state_t state;
+    XXH3_64bits_reset(&state);
+    HashObject(&state, pgm_hash);
+    HashObject(&state, spec.start);
+    HashObject(&state, spec.info->has_readconst);
+
+    // The copy shader span points into guest memory, its contents are covered by vs_copy_hash.
+    auto runtime_info = spec.runtime_info;
+    if (runtime_info.stage == Shader::Stage::Geometry) {
+        runtime_info.gs_info.vs_copy = {};
+    }
+    HashObject(&state, runtime_info);
+
+    HashObject(&state, spec.bitset.to_ullong());
+    HashElements(&state, spec.buffers);
+    HashElements(&state, spec.tex_buffers);
+    HashElements(&state, spec.images);
+    HashElements(&state, spec.fmasks);
+    return XXH3_64bits_digest(&state);
+}
+
+std::span<const u32> ShaderCache::FindModule(u64 key) const {
+    const auto it = modules.find(key);
+    if (it == modules.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+void ShaderCache::StoreModule(u64 key, std::span<const u32> spv) {
+    if (!enabled || spv.empty()) {
+        return;
+    }
+    const auto [it, is_new] = modules.try_emplace(key, spv.begin(), spv.end());
+    if (!is_new) {
+        return;
+    }
+    const ModuleEntry entry = {
+        .key = key,
+        .checksum = XXH3_64bits(spv.data(), spv.size_bytes()),
+        .num_words = static_cast<u32>(spv.size()),
+        .reserved = 0,
+    };
+    // Entries are only appended, so a crash can at most leave a torn entry at the end which is
+    // detected through its checksum and truncated on the next boot.
+    if (!module_file.WriteObject(entry) || module_file.WriteSpan(spv) != spv.size()) {
+        LOG_ERROR(Render_Vulkan, "Failed to write shader {:#x} to the cache", key);
+    }
+    module_file.Flush();
+}
+
+std::vector<u8> ShaderCache::LoadPipelineData() const {
+    if (!enabled) {
+        return {};
+    }
+    const auto path = cache_dir / PipelineFileName;
+    if (!std::filesystem::exists(path)) {
+        return {};
+    }
+    const IOFile file{path, FileAccessMode::Read};
+    FileHeader file_header{};
+    PipelineDataHeader data_header{};
+    if (!file.ReadObject(file_header) || file_header != header ||
+        !file.ReadObject(data_header) || data_header.size > file.GetSize()) {
+        LOG_INFO(Render_Vulkan, "Discarding stale pipeline cache");
+        return {};
+    }
+    std::vector<u8> data(data_header.size);
+    if (file.ReadSpan(std::span{data}) != data.size() ||
+        XXH3_64bits(data.data(), data.size()) != data_header.checksum) {
+        LOG_WARNING(Render_Vulkan, "Pipeline cache is corrupted, discarding");
+        return {};
+    }
+    LOG_INFO(Render_Vulkan, "Loaded {} KB of pipeline cache data", data.size() / 1024);
+    return data;
+}
+
+void ShaderCache::SavePipelineData(std::span<const u8> data) const {
+    if (!enabled || data.empty()) {
+        return;
+    }
+    // Write the new blob next to the old one and swap it in, so an interrupted write never
+    // replaces a valid cache with a partial one.
+    const auto path = cache_dir / PipelineFileName;
+    auto temp_path = path;
+    temp_path += ".tmp";
+    {
+        const IOFile file{temp_path, FileAccessMode::Write};
+        const PipelineDataHeader data_header = {
+            .size = data.size(),
+            .checksum = XXH3_64bits(data.data(), data.size()),
+        };
+        if (!file.WriteObject(header) || !file.WriteObject(data_header) ||
+            file.WriteSpan(data) != data.size() || !file.Commit()) {
+            LOG_ERROR(Render_Vulkan, "Failed to write pipeline cache");
+            return;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(temp_path, path, ec);
+    if (ec) {
+        LOG_ERROR(Render_Vulkan, "Failed to replace pipeline cache: {}", ec.message());
+    }
+}
+
+void ShaderCache::LoadModules() {
+    const auto path = cache_dir / ModuleFileName;
+    if (!std::filesystem::exists(path)) {
+        ResetModuleFile();
+        return;
+    }
+
+    module_file.Open(path, FileAccessMode::ReadWrite);
+    FileHeader file_header{};
+    if (!module_file.ReadObject(file_header) || file_header != header) {
+        LOG_INFO(Render_Vulkan, "Shader cache was built by a different revision, discarding");
+        module_file.Close();
+        ResetModuleFile();
+        return;
+    }
+
+    const u64 file_size = module_file.GetSize();
+    s64 valid_size = module_file.Tell();
+    ModuleEntry entry{};
+    std::vector<u32> spv;
+    while (module_file.ReadObject(entry)) {
+        const u64 data_size = u64(entry.num_words) * sizeof(u32);
+        if (u64(valid_size) + sizeof(ModuleEntry) + data_size > file_size) {
+            break;
+        }
+        spv.resize(entry.num_words);
+        if (module_file.ReadSpan(std::span{spv}) != spv.size() ||
+            XXH3_64bits(spv.data(), data_size) != entry.checksum) {
+            break;
+        }
+        modules.insert_or_assign(entry.key, std::move(spv));
+        valid_size = module_file.Tell();
+    }
+
+    if (u64(valid_size) != file_size) {
+        LOG_WARNING(Render_Vulkan, "Truncating {} bytes of damaged shader cache entries",
+                    file_size - valid_size);
+        module_file.SetSize(valid_size);
+    }
+    module_file.Seek(valid_size);
+    LOG_INFO(Render_Vulkan, "Loaded {} shaders from the shader cache", modules.size());
+}
+
+void ShaderCache::ResetModuleFile() {
+    modules.clear();
+    module_file.Open(cache_dir / ModuleFileName, FileAccessMode::Write);
+    if (!module_file.WriteObject(header)) {
+        LOG_ERROR(Render_Vulkan, "Failed to create shader cache, disabling it");
+        module_file.Close();
+        enabled = false;
+        return;
+    }
+    module_file.Flush();
+}
+
+} // namespace Vulkan
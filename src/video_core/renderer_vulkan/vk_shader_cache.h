@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <span>
+#include <vector>
+#include <tsl/robin_map.h>
+
+#include "common/io_file.h"
+#include "common/types.h"
+
+namespace Shader {
+struct StageSpecialization;
+}
+
+namespace Vulkan {
+
+class Instance;
+
+/**
+ * Persistent on-disk storage of recompiled SPIR-V modules and of the driver pipeline cache blob.
+ * Modules are keyed by the GCN program hash combined with its stage specialization. The whole
+ * cache is discarded when the recompiler revision or the host device/driver changes.
+ */
+class ShaderCache {
+public:
+    explicit ShaderCache(const Instance& instance);
+    ~ShaderCache();
+
+    ShaderCache(const ShaderCache&) = delete;
+    ShaderCache& operator=(const ShaderCache&) = delete;
+
+    /// Computes the cache key of a shader permutation.
+    [[nodiscard]] static u64 ComputeModuleKey(u64 pgm_hash,
+                                              const Shader::StageSpecialization& spec);
+
+    /// Returns the cached SPIR-V for the provided key, or an empty span if it is not present.
+    [[nodiscard]] std::span<const u32> FindModule(u64 key) const;
+
+    /// Appends a newly compiled SPIR-V module to the cache.
+    void StoreModule(u64 key, std::span<const u32> spv);
+
+    /// Returns the driver pipeline cache blob saved by a previous session.
+    [[nodiscard]] std::vector<u8> LoadPipelineData() const;
+
+    /// Atomically replaces the stored driver pipeline cache blob.
+    void SavePipelineData(std::span<const u8> data) const;
+
+    [[nodiscard]] bool IsEnabled() const noexcept {
+        return enabled;
+    }
+
+private:
+    struct FileHeader {
+        u32 magic;
+        u32 format_version;
+        u32 recompiler_version;
+        u32 vendor_id;
+        u32 device_id;
+        u32 driver_version;
+        u64 build_hash;
+        std::array<u8, 16> pipeline_cache_uuid;
+
+        auto operator<=>(const FileHeader&) const = default;
+    };
+
+    struct ModuleEntry {
+        u64 key;
+        u64 checksum;
+        u32 num_words;
+        u32 reserved;
+    };
+
+    struct PipelineDataHeader {
+        u64 size;
+        u64 checksum;
+    };
+
+    void LoadModules();
+    void ResetModuleFile();
+
+private:
+    FileHeader header{};
+    std::filesystem::path cache_dir;
+    Common::FS::IOFile module_file;
+    tsl::robin_map<u64, std::vector<u32>> modules;
+    bool enabled{};
+};
+
+} // namespace Vulkan
@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <algorithm>
+#include <utility>
+#include "common/assert.h"
+#include "video_core/renderer_vulkan/vk_instance.h"
+#include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/renderer_vulkan/vk_upload_scheduler.h"
+
+namespace Vulkan {
+
+static vk::CommandBuffer BeginCommandBuffer(CommandPool& pool) {
+    const vk::CommandBufferBeginInfo begin_info = {
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit,
+    };
+    const vk::CommandBuffer cmdbuf = pool.Commit();
+    const auto begin_result = cmdbuf.begin(begin_info);
+    ASSERT_MSG(begin_result == vk::Result::eSuccess, "Failed to begin command buffer: {}",
+               vk::to_string(begin_result));
+    return cmdbuf;
+}
+
+static void EndCommandBuffer(vk::CommandBuffer cmdbuf) {
+    const auto end_result = cmdbuf.end();
+    ASSERT_MSG(end_result == vk::Result::eSuccess, "Failed to end command buffer: {}",
+               vk::to_string(end_result));
+}
+
+// Command buffers of both pools are recycled with the graphics timeline, the graphics
+// submission always completes after the upload batch it waited on.
+UploadScheduler::UploadScheduler(const Instance& instance_, MasterSemaphore* master_semaphore)
+    : instance{instance_}, upload_semaphore{instance},
+      upload_pool{instance, master_semaphore, instance.GetTransferQueueFamilyIndex()},
+      graphics_pool{instance, master_semaphore}, has_transfer_queue{instance.HasTransferQueue()} {
+}
+
+UploadScheduler::~UploadScheduler() = default;
+
+vk::CommandBuffer UploadScheduler::CommandBuffer() {
+    if (!upload_cmdbuf) {
+        upload_cmdbuf = BeginCommandBuffer(upload_pool);
+    }
+    return upload_cmdbuf;
+}
+
+void UploadScheduler::ReleaseBuffer(vk::Buffer buffer) {
+    if (!has_transfer_queue) {
+        return;
+    }
+    buffer_barriers.push_back({
+        .srcQueueFamilyIndex = instance.GetTransferQueueFamilyIndex(),
+        .dstQueueFamilyIndex = instance.GetGraphicsQueueFamilyIndex(),
+        .buffer = buffer,
+        .offset = 0,
+        .size = VK_WHOLE_SIZE,
+    });
+}
+
+void UploadScheduler::ReleaseImage(vk::Image image, vk::ImageAspectFlags aspect_mask) {
+    if (!has_transfer_queue) {
+        return;
+    }
+    image_barriers.push_back({
+        .oldLayout = vk::ImageLayout::eTransferDstOptimal,
+        .newLayout = vk::ImageLayout::eTransferDstOptimal,
+        .srcQueueFamilyIndex = instance.GetTransferQueueFamilyIndex(),
+        .dstQueueFamilyIndex = instance.GetGraphicsQueueFamilyIndex(),
+        .image = image,
+        .subresourceRange{
+            .aspectMask = aspect_mask,
+            .baseMipLevel = 0,
+            .levelCount = VK_REMAINING_MIP_LEVELS,
+            .baseArrayLayer = 0,
+            .layerCount = VK_REMAINING_ARRAY_LAYERS,
+        },
+    });
+}
+
+vk::CommandBuffer UploadScheduler::Flush(SubmitInfo& info) {
+    if (!upload_cmdbuf) {
+        return {};
+    }
+    const vk::CommandBuffer cmdbuf = std::exchange(upload_cmdbuf, vk::CommandBuffer{});
+    if (!has_transfer_queue) {
+        // The pre-pass is submitted in the same batch, a barrier makes its writes visible.
+        const vk::MemoryBarrier2 barrier = {
+            .srcStageMask = vk::PipelineStageFlagBits2::eTransfer,
+            .srcAccessMask = vk::AccessFlagBits2::eTransferWrite,
+            .dstStageMask = vk::PipelineStageFlagBits2::eAllCommands,
+            .dstAccessMask = vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite,
+        };
+        cmdbuf.pipelineBarrier2(vk::DependencyInfo{
+            .memoryBarrierCount = 1,
+            .pMemoryBarriers = &barrier,
+        });
+        EndCommandBuffer(cmdbuf);
+        return cmdbuf;
+    }
+
+    // Release the written resources on the transfer queue.
+    const auto set_release_scope = [](auto& barrier) {
+        barrier.srcStageMask = vk::PipelineStageFlagBits2::eTransfer;
+        barrier.srcAccessMask = vk::AccessFlagBits2::eTransferWrite;
+    };
+    std::ranges::for_each(buffer_barriers, set_release_scope);
+    std::ranges::for_each(image_barriers, set_release_scope);
+    const vk::DependencyInfo release_info = {
+        .bufferMemoryBarrierCount = static_cast<u32>(buffer_barriers.size()),
+        .pBufferMemoryBarriers = buffer_barriers.data(),
+        .imageMemoryBarrierCount = static_cast<u32>(image_barriers.size()),
+        .pImageMemoryBarriers = image_barriers.data(),
+    };
+    cmdbuf.pipelineBarrier2(release_info);
+    EndCommandBuffer(cmdbuf);
+
+    const u64 signal_value = upload_semaphore.NextTick();
+    const vk::Semaphore timeline = upload_semaphore.Handle();
+    const vk::TimelineSemaphoreSubmitInfo timeline_si = {
+        .signalSemaphoreValueCount = 1U,
+        .pSignalSemaphoreValues = &signal_value,
+    };
+    const vk::SubmitInfo submit_info = {
+        .pNext = &timeline_si,
+        .commandBufferCount = 1U,
+        .pCommandBuffers = &cmdbuf,
+        .signalSemaphoreCount = 1U,
+        .pSignalSemaphores = &timeline,
+    };
+    const auto submit_result = instance.GetTransferQueue().submit(submit_info);
+    ASSERT_MSG(submit_result != vk::Result::eErrorDeviceLost, "Device lost during submit");
+    info.AddWait(timeline, signal_value);
+
+    // Acquire them on the graphics queue before the graphics command buffer runs.
+    const auto set_acquire_scope = [](auto& barrier) {
+        barrier.srcStageMask = vk::PipelineStageFlagBits2::eNone;
+        barrier.srcAccessMask = vk::AccessFlagBits2::eNone;
+        barrier.dstStageMask = vk::PipelineStageFlagBits2::eAllCommands;
+        barrier.dstAccessMask =
+            vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite;
+    };
+    std::ranges::for_each(buffer_barriers, set_acquire_scope);
+    std::ranges::for_each(image_barriers, set_acquire_scope);
+    const vk::CommandBuffer acquire_cmdbuf = BeginCommandBuffer(graphics_pool);
+    acquire_cmdbuf.pipelineBarrier2(release_info);
+    EndCommandBuffer(acquire_cmdbuf);
+
+    buffer_barriers.clear();
+    image_barriers.clear();
+    return acquire_cmdbuf;
+}
+
+} // namespace Vulkan
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#pragma once
+
+#include <vector>
+#include "common/types.h"
+#include "video_core/renderer_vulkan/vk_master_semaphore.h"
+#include "video_core/renderer_vulkan/vk_resource_pool.h"
+
+namespace Vulkan {
+
+class Instance;
+struct SubmitInfo;
+
+/**
+ * Batches uploads to resources that have not been used by the GPU yet, so they do not interrupt
+ * rendering. The batch executes ahead of the graphics command buffer of the owning scheduler.
+ * When the device has a dedicated transfer queue it is submitted there and the graphics
+ * submission waits on a timeline semaphore, otherwise it is submitted as a pre-pass together
+ * with the graphics command buffer.
+ */
+class UploadScheduler {
+public:
+    explicit UploadScheduler(const Instance& instance, MasterSemaphore* master_semaphore);
+    ~UploadScheduler();
+
+    UploadScheduler(const UploadScheduler&) = delete;
+    UploadScheduler& operator=(const UploadScheduler&) = delete;
+
+    /// Returns the command buffer of the current upload batch.
+    vk::CommandBuffer CommandBuffer();
+
+    /// Hands a buffer written by the upload batch over to the graphics queue.
+    void ReleaseBuffer(vk::Buffer buffer);
+
+    /// Hands an image written by the upload batch over to the graphics queue. The image must be
+    /// left in transfer destination layout.
+    void ReleaseImage(vk::Image image, vk::ImageAspectFlags aspect_mask);
+
+    /// Submits the current upload batch and makes the graphics submission described by info
+    /// wait for it. Returns a command buffer that must execute before the graphics command
+    /// buffer or a null handle if there is nothing to execute.
+    [[nodiscard]] vk::CommandBuffer Flush(SubmitInfo& info);
+
+    /// Returns true when uploads are submitted to a dedicated transfer queue.
+    [[nodiscard]] bool HasTransferQueue() const noexcept {
+        return has_transfer_queue;
+    }
+
+private:
+    const Instance& instance;
+    MasterSemaphore upload_semaphore;
+    CommandPool upload_pool;
+    CommandPool graphics_pool;
+    vk::CommandBuffer upload_cmdbuf;
+    std::vector<vk::BufferMemoryBarrier2> buffer_barriers;
+    std::vector<vk::ImageMemoryBarrier2> image_barriers;
+    bool has_transfer_queue;
+};
+
+} // namespace Vulkan
@@ -3,13 +3,16 @@
 
 #pragma once
 
+#include "common/div_ceil.h"
 #include "common/enum.h"
 #include "common/types.h"
 #include "video_core/renderer_vulkan/vk_common.h"
 #include "video_core/texture_cache/image_info.h"
 #include "video_core/texture_cache/image_view.h"
 
+#include <algorithm>
 #include <optional>
+#include <vector>
 
 namespace Vulkan {
 class Instance;
@@ -45,16 +48,23 @@ struct UniqueImage {
     UniqueImage(UniqueImage&& other)
         : allocator{std::exchange(other.allocator, VK_NULL_HANDLE)},
           allocation{std::exchange(other.allocation, VK_NULL_HANDLE)},
-          image{std::exchange(other.image, VK_NULL_HANDLE)} {}
+          image{std::exchange(other.image, VK_NULL_HANDLE)},
+          allocation_size{std::exchange(other.allocation_size, 0)} {}
     UniqueImage& operator=(UniqueImage&& other) {
         image = std::exchange(other.image, VK_NULL_HANDLE);
         allocator = std::exchange(other.allocator, VK_NULL_HANDLE);
         allocation = std::exchange(other.allocation, VK_NULL_HANDLE);
+        allocation_size = std::exchange(other.allocation_size, 0);
         return *this;
     }
 
     void Create(const vk::ImageCreateInfo& image_ci);
 
+    /// Returns the size in bytes of the memory backing the image.
+    u64 AllocationSize() const {
+        return allocation_size;
+    }
+
     operator vk::Image() const {
         return image;
     }
@@ -64,6 +74,102 @@ private:
     VmaAllocator allocator;
     VmaAllocation allocation;
     vk::Image image{};
+    u64 allocation_size{};
+};
+
+/// Bitmap with one bit per guest page covered by an image.
+class ImagePageMask {
+public:
+    static constexpr u64 PageBits = 12;
+    static constexpr u64 PageSize = u64{1} << PageBits;
+
+    void Resize(size_t num_pages_) {
+        num_pages = num_pages_;
+        words.assign(Common::DivCeil(num_pages, WordBits), 0);
+        count = 0;
+    }
+
+    [[nodiscard]] size_t NumPages() const noexcept {
+        return num_pages;
+    }
+
+    [[nodiscard]] size_t Count() const noexcept {
+        return count;
+    }
+
+    [[nodiscard]] bool Empty() const noexcept {
+        return count == 0;
+    }
+
+    /// Sets the bit of a page, returns false if it was already set.
+    bool Set(size_t page) {
+        u64& word = words[page / WordBits];
+        const u64 bit = u64{1} << (page % WordBits);
+        if (word & bit) {
+            return false;
+        }
+        word |= bit;
+        ++count;
+        return true;
+    }
+
+    void SetAll() {
+        std::ranges::fill(words, ~u64{0});
+        if (const size_t tail = num_pages % WordBits; tail != 0) {
+            words.back() = (u64{1} << tail) - 1;
+        }
+        count = num_pages;
+    }
+
+    void Clear() {
+        std::ranges::fill(words, 0);
+        count = 0;
+    }
+
+    /// Returns a copy of the mask and clears this one.
+    [[nodiscard]] ImagePageMask Take() {
+        ImagePageMask taken{*this};
+        Clear();
+        return taken;
+    }
+
+    /// Invokes func(first_page, num_pages) for every run of consecutive pages whose bit matches
+    /// value.
+    template <bool value, typename Func>
+    void ForEachRun(Func&& func) const {
+        size_t run_begin = 0;
+        bool in_run = false;
+        for (size_t page = 0; page < num_pages; ++page) {
+            const u64 word = words[page / WordBits];
+            if ((page % WordBits) == 0 && word == (value ? 0 : ~u64{0})) {
+                // Skip whole words without matching bits.
+                if (in_run) {
+                    func(run_begin, page - run_begin);
+                    in_run = false;
+                }
+                page += WordBits - 1;
+                continue;
+            }
+            const bool bit = ((word >> (page % WordBits)) & 1) != 0;
+            if (bit == value && !in_run) {
+                run_begin = page;
+                in_run = true;
+            } else if (bit != value && in_run) {
+                func(run_begin, page - run_begin);
+                in_run = false;
+            }
+        }
+        if (in_run) {
+            func(run_begin, num_pages - run_begin);
+        }
+    }
+
+private:
+    static constexpr size_t WordBits = 64;
+
+    std::vector<u64> words;
+    size_t num_pages{};
+    size_t count{};
 };
 
 constexpr Common::SlotId NULL_IMAGE_ID{0};
@@ -101,6 +207,22 @@ struct Image {
     void CopyImage(const Image& image);
     void CopyMip(const Image& image, u32 mip);
 
+    /// Returns true if the CPU written pages of the image can be uploaded on their own.
+    [[nodiscard]] bool SupportsPartialUpload() const noexcept {
+        return !info.IsTiled() && !info.props.is_block && !info.props.is_volume &&
+               info.num_samples == 1;
+    }
+
+    /// Returns the index of the page containing addr relative to the first page of the image.
+    [[nodiscard]] size_t PageIndex(VAddr addr) const noexcept {
+        return (addr >> ImagePageMask::PageBits) - (cpu_addr >> ImagePageMask::PageBits);
+    }
+
+    /// Returns the guest address of a page index returned by PageIndex.
+    [[nodiscard]] VAddr PageAddress(size_t page) const noexcept {
+        return ((cpu_addr >> ImagePageMask::PageBits) + page) << ImagePageMask::PageBits;
+    }
+
     const Vulkan::Instance* instance;
     Vulkan::Scheduler* scheduler;
     ImageInfo info;
@@ -124,6 +246,10 @@ struct Image {
     std::vector<State> subresource_states{};
     boost::container::small_vector<u64, 14> mip_hashes{};
     u64 tick_accessed_last{0};
+
+    // Page granular CPU write tracking, only used by images supporting partial uploads.
+    ImagePageMask untracked_pages; ///< Written pages that stopped being tracked.
+    ImagePageMask upload_pages;    ///< Pages that have to be uploaded on the next refresh.
 };
 
 } // namespace VideoCore
@@ -1,13 +1,19 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include <algorithm>
+#include <cstring>
+#include <latch>
 #include <optional>
 #include <xxhash.h>
 #include "common/assert.h"
+#include "common/thread_worker.h"
 #include "video_core/buffer_cache/buffer_cache.h"
+#include "video_core/gpu_stats.h"
 #include "video_core/page_manager.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
+#include "video_core/renderer_vulkan/vk_upload_scheduler.h"
 #include "video_core/texture_cache/host_compatibility.h"
 #include "video_core/texture_cache/texture_cache.h"
 #include "video_core/texture_cache/tile_manager.h"
@@ -16,6 +22,47 @@ namespace VideoCore {
 
 static constexpr u64 PageShift = 12;
 static constexpr u64 NumFramesBeforeRemoval = 32;
+static constexpr u64 ParallelHashSize = 1_MB;
+static constexpr u64 HashTaskSize = 256_KB;
+
+/// Hashes guest memory of a mip level, large levels are split in chunks hashed by the worker.
+static u64 HashMipData(const u8* data, u64 size, Common::ThreadWorker* worker) {
+    if (!worker || size < ParallelHashSize) {
+        return XXH3_64bits(data, size);
+    }
+    const u64 num_tasks = Common::DivCeil(size, HashTaskSize);
+    boost::container::small_vector<u64, 64> hashes(num_tasks);
+    std::latch done{static_cast<std::ptrdiff_t>(num_tasks)};
+    for (u64 task = 0; task < num_tasks; ++task) {
+        const u64 offset = task * HashTaskSize;
+        const u64 task_size = std::min(HashTaskSize, size - offset);
+        worker->QueueWork([&, task, offset, task_size] {
+            hashes[task] = XXH3_64bits(data + offset, task_size);
+            done.count_down();
+        });
+    }
+    done.wait();
+    return XXH3_64bits(hashes.data(), hashes.size() * sizeof(u64));
+}
+
+/// Returns a view of guest memory for a transfer to an image, waiting for pending shader writes.
+static std::pair<Buffer*, u32> ObtainSourceBuffer(BufferCache& buffer_cache,
+                                                  vk::CommandBuffer cmdbuf, VAddr addr,
+                                                  u32 size) {
+    const auto [vk_buffer, buf_offset] = buffer_cache.ObtainViewBuffer(addr, size);
+    // The obtained buffer may be written by a shader so we need to emit a barrier to prevent
+    // RAW hazard
+    if (auto barrier = vk_buffer->GetBarrier(vk::AccessFlagBits2::eTransferRead,
+                                             vk::PipelineStageFlagBits2::eTransfer)) {
+        const auto dependencies = vk::DependencyInfo{
+            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
+            .bufferMemoryBarrierCount = 1,
+            .pBufferMemoryBarriers = &barrier.value(),
+        };
+        cmdbuf.pipelineBarrier2(dependencies);
+    }
+    return {vk_buffer, buf_offset};
+}
 
 TextureCache::TextureCache(const Vulkan::Instance& instance_, Vulkan::Scheduler& scheduler_,
                            BufferCache& buffer_cache_, PageManager& tracker_)
@@ -48,6 +95,14 @@ void TextureCache::InvalidateMemory(VAddr address, size_t size) {
     ForEachImageInRegion(address, size, [&](ImageId image_id, Image& image) {
         // Ensure image is reuploaded when accessed again.
         image.flags |= ImageFlagBits::CpuDirty;
+        if (image.SupportsPartialUpload() && True(image.flags & ImageFlagBits::Tracked)) {
+            // Only unprotect the written pages so the next upload can skip the rest of the image.
+            // Once most of it was written it is cheaper to let the guest write freely.
+            UntrackImagePages(image, address, size);
+            if (image.untracked_pages.Count() <= image.untracked_pages.NumPages() / 2) {
+                return;
+            }
+        }
         // Untrack image, so the range is unprotected and the guest can write freely.
         UntrackImage(image_id);
     });
@@ -77,6 +132,36 @@ void TextureCache::UnmapMemory(VAddr cpu_addr, size_t size) {
     }
 }
 
+u64 TextureCache::EvictImages(u64 bytes_to_free, u64 min_age) {
+    std::scoped_lock lk{mutex};
+
+    const u64 current_tick = scheduler.CurrentTick();
+    std::vector<ImageId> candidates;
+    slot_images.ForEach([&](ImageId image_id, const Image& image) {
+        // Images written by the GPU have no copy in guest memory to be recreated from.
+        if (False(image.flags & ImageFlagBits::Registered) ||
+            True(image.flags & ImageFlagBits::GpuModified) ||
+            current_tick - image.tick_accessed_last < min_age) {
+            return;
+        }
+        candidates.push_back(image_id);
+    });
+    std::ranges::sort(candidates, {}, [this](ImageId image_id) {
+        return slot_images[image_id].tick_accessed_last;
+    });
+
+    u64 bytes_freed = 0;
+    for (const ImageId image_id : candidates) {
+        if (bytes_freed >= bytes_to_free) {
+            break;
+        }
+        bytes_freed += slot_images[image_id].image.AllocationSize();
+        FreeImage(image_id);
+    }
+    GpuStats::Instance().Add(Stat::EvictedImageBytes, bytes_freed);
+    return bytes_freed;
+}
+
 ImageId TextureCache::ResolveDepthOverlap(const ImageInfo& requested_info, ImageId cache_image_id) {
     const auto& cache_info = slot_images[cache_image_id].info;
 
@@ -189,6 +274,7 @@ ImageId TextureCache::ExpandImage(const ImageInfo& info, ImageId image_id) {
 
     TrackImage(new_image_id);
     new_image.flags &= ~ImageFlagBits::Dirty;
+    new_image.upload_pages.Clear();
     return new_image_id;
 }
 
@@ -380,6 +466,26 @@ void TextureCache::RefreshImage(Image& image, Vulkan::Scheduler* custom_schedule
         return;
     }
 
+    // Written pages are marked by the page fault handler on another thread. Consume them along
+    // with the dirty flags before guest memory is read, a write racing with the upload then marks
+    // the image dirty again instead of being lost.
+    ImagePageMask upload_pages;
+    bool is_gpu_dirty;
+    {
+        std::scoped_lock lock{mutex};
+        is_gpu_dirty = True(image.flags & ImageFlagBits::GpuDirty);
+        image.flags &= ~ImageFlagBits::Dirty;
+        upload_pages = image.upload_pages.Take();
+    }
+
+    // Images only written by the CPU since the last upload are refreshed page by page.
+    if (image.SupportsPartialUpload() && !is_gpu_dirty &&
+        False(image.flags & ImageFlagBits::GpuModified) &&
+        upload_pages.Count() < upload_pages.NumPages()) {
+        RefreshImagePages(image, upload_pages, custom_scheduler);
+        return;
+    }
+
     const auto& num_layers = image.info.resources.layers;
     const auto& num_mips = image.info.resources.levels;
     ASSERT(num_mips == image.info.mips_layout.size());
@@ -394,10 +500,9 @@ void TextureCache::RefreshImage(Image& image, Vulkan::Scheduler* custom_schedule
 
         // Protect GPU modified resources from accidental CPU reuploads.
         const bool is_gpu_modified = True(image.flags & ImageFlagBits::GpuModified);
-        const bool is_gpu_dirty = True(image.flags & ImageFlagBits::GpuDirty);
         if (is_gpu_modified && !is_gpu_dirty) {
             const u8* addr = std::bit_cast<u8*>(image.info.guest_address);
-            const u64 hash = XXH3_64bits(addr + mip_ofs, mip_size);
+            const u64 hash = HashMipData(addr + mip_ofs, mip_size, tile_manager.HostWorker());
             if (image.mip_hashes[m] == hash) {
                 continue;
             }
@@ -423,6 +528,48 @@ void TextureCache::RefreshImage(Image& image, Vulkan::Scheduler* custom_schedule
         return;
     }
 
+    const VAddr image_addr = image.info.guest_address;
+    const size_t image_size = image.info.guest_size_bytes;
+    GpuStats::Instance().Add(Stat::UploadBytes, image_size);
+
+    // Data that is not cached by the GPU is copied to the staging buffer, detile it as part of
+    // that copy instead of running a compute pass over it later.
+    const bool is_host_staged = !buffer_cache.IsRegionRegistered(image_addr, image_size) &&
+                                !buffer_cache.IsRegionGpuModified(image_addr, image_size);
+    const auto stage_on_host = [&] {
+        auto& staging = buffer_cache.GetStagingBuffer();
+        const auto [data, staging_offset] = staging.Map(image_size, 16);
+        if (image.info.IsTiled()) {
+            tile_manager.DetileOnHost({data, image_size}, image);
+        } else {
+            std::memcpy(data, std::bit_cast<const u8*>(image_addr), image_size);
+        }
+        staging.Commit();
+        for (auto& copy : image_copy) {
+            copy.bufferOffset += staging_offset;
+        }
+        return staging.Handle();
+    };
+
+    // Color images that were never used by the GPU are uploaded in the upload batch, this
+    // neither interrupts rendering nor needs the graphics queue.
+    auto* upload_scheduler = custom_scheduler ? nullptr : scheduler.GetUploadScheduler();
+    if (upload_scheduler && is_host_staged &&
+        (tile_manager.CanDetileOnHost(image) || !image.info.IsTiled()) &&
+        image.aspect_mask == vk::ImageAspectFlagBits::eColor &&
+        image.last_state.layout == vk::ImageLayout::eUndefined &&
+        image.subresource_states.empty()) {
+        const vk::Buffer buffer = stage_on_host();
+        const auto cmdbuf = upload_scheduler->CommandBuffer();
+        image.Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite,
+                      {}, cmdbuf);
+        cmdbuf.copyBufferToImage(buffer, image.image, vk::ImageLayout::eTransferDstOptimal,
+                                 image_copy);
+        upload_scheduler->ReleaseImage(image.image, image.aspect_mask);
+        GpuStats::Instance().Add(Stat::DeferredUploads);
+        return;
+    }
+
     auto* sched_ptr = custom_scheduler ? custom_scheduler : &scheduler;
     sched_ptr->EndRendering();
 
@@ -430,28 +577,132 @@ void TextureCache::RefreshImage(Image& image, Vulkan::Scheduler* custom_schedule
     image.Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {},
                   cmdbuf);
 
-    const VAddr image_addr = image.info.guest_address;
-    const size_t image_size = image.info.guest_size_bytes;
-    const auto [vk_buffer, buf_offset] = buffer_cache.ObtainViewBuffer(image_addr, image_size);
-    // The obtained buffer may be written by a shader so we need to emit a barrier to prevent RAW
-    // hazard
-    if (auto barrier = vk_buffer->GetBarrier(vk::AccessFlagBits2::eTransferRead,
-                                             vk::PipelineStageFlagBits2::eTransfer)) {
-        const auto dependencies = vk::DependencyInfo{
-            .dependencyFlags = vk::DependencyFlagBits::eByRegion,
-            .bufferMemoryBarrierCount = 1,
-            .pBufferMemoryBarriers = &barrier.value(),
-        };
-        cmdbuf.pipelineBarrier2(dependencies);
+    const vk::Buffer buffer = [&] {
+        if (is_host_staged && tile_manager.CanDetileOnHost(image)) {
+            return stage_on_host();
+        }
+        const auto [vk_buffer, buf_offset] =
+            ObtainSourceBuffer(buffer_cache, cmdbuf, image_addr, image_size);
+        const auto [src_buffer, src_offset] =
+            tile_manager.TryDetile(vk_buffer->Handle(), buf_offset, image);
+        for (auto& copy : image_copy) {
+            copy.bufferOffset += src_offset;
+        }
+        return src_buffer;
+    }();
+
+    cmdbuf.copyBufferToImage(buffer, image.image, vk::ImageLayout::eTransferDstOptimal, image_copy);
+}
+
+void TextureCache::RefreshImagePages(Image& image, const ImagePageMask& upload_pages,
+                                     Vulkan::Scheduler* custom_scheduler) {
+    const auto& info = image.info;
+    const u32 num_layers = info.resources.layers;
+
+    // Byte ranges of the image that were written, relative to its base address.
+    boost::container::small_vector<std::pair<u64, u64>, 8> dirty_ranges;
+    upload_pages.ForEachRun<true>([&](size_t first_page, size_t num_pages) {
+        const VAddr start = std::max(image.PageAddress(first_page), image.cpu_addr);
+        const VAddr end = std::min(image.PageAddress(first_page + num_pages), image.cpu_addr_end);
+        dirty_ranges.emplace_back(start - image.cpu_addr, end - image.cpu_addr);
+    });
+
+    // Convert the written ranges to the rows of each subresource they cover, merging ranges that
+    // touch the same rows.
+    boost::container::small_vector<vk::BufferImageCopy, 14> image_copy{};
+    size_t upload_size = 0;
+    for (u32 m = 0; m < info.resources.levels; m++) {
+        const u32 width = std::max(info.size.width >> m, 1u);
+        const u32 height = std::max(info.size.height >> m, 1u);
+        const auto& [mip_size, mip_pitch, mip_height, mip_ofs] = info.mips_layout[m];
+        const u64 row_bytes = mip_pitch * info.num_bits / 8;
+        for (u32 l = 0; l < num_layers; l++) {
+            const u64 layer_ofs = mip_ofs * num_layers + l * mip_size;
+            u32 row_begin = 0;
+            u32 row_end = 0;
+            const auto add_copy = [&] {
+                if (row_begin == row_end) {
+                    return;
+                }
+                image_copy.push_back({
+                    .bufferOffset = layer_ofs + row_begin * row_bytes,
+                    .bufferRowLength = static_cast<u32>(mip_pitch),
+                    .bufferImageHeight = row_end - row_begin,
+                    .imageSubresource{
+                        .aspectMask = image.aspect_mask & ~vk::ImageAspectFlagBits::eStencil,
+                        .mipLevel = m,
+                        .baseArrayLayer = l,
+                        .layerCount = 1,
+                    },
+                    .imageOffset = {0, static_cast<s32>(row_begin), 0},
+                    .imageExtent = {width, row_end - row_begin, 1},
+                });
+                upload_size += (row_end - row_begin) * row_bytes;
+            };
+            for (const auto& [start, end] : dirty_ranges) {
+                if (end <= layer_ofs || start >= layer_ofs + mip_size) {
+                    continue;
+                }
+                const u32 first_row = start > layer_ofs ? (start - layer_ofs) / row_bytes : 0;
+                const u32 last_row = static_cast<u32>(
+                    std::min<u64>(Common::DivCeil(end - layer_ofs, row_bytes), height));
+                if (first_row >= last_row) {
+                    continue;
+                }
+                if (first_row <= row_end) {
+                    row_end = std::max(row_end, last_row);
+                } else {
+                    add_copy();
+                    row_begin = first_row;
+                    row_end = last_row;
+                }
+            }
+            add_copy();
+        }
+    }
+
+    if (image_copy.empty()) {
+        return;
     }
+    GpuStats::Instance().Add(Stat::PartialImageUploads);
+    GpuStats::Instance().Add(Stat::UploadBytes, upload_size);
+
+    auto* sched_ptr = custom_scheduler ? custom_scheduler : &scheduler;
+    sched_ptr->EndRendering();
 
-    const auto [buffer, offset] = tile_manager.TryDetile(vk_buffer->Handle(), buf_offset, image);
-    for (auto& copy : image_copy) {
-        copy.bufferOffset += offset;
+    const auto cmdbuf = sched_ptr->CommandBuffer();
+    image.Transit(vk::ImageLayout::eTransferDstOptimal, vk::AccessFlagBits2::eTransferWrite, {},
+                  cmdbuf);
+
+    const VAddr image_addr = info.guest_address;
+    const size_t image_size = info.guest_size_bytes;
+    vk::Buffer buffer;
+    if (buffer_cache.IsRegionRegistered(image_addr, image_size) ||
+        buffer_cache.IsRegionGpuModified(image_addr, image_size)) {
+        const auto [vk_buffer, offset] =
+            ObtainSourceBuffer(buffer_cache, cmdbuf, image_addr, image_size);
+        buffer = vk_buffer->Handle();
+        for (auto& copy : image_copy) {
+            copy.bufferOffset += offset;
+        }
+    } else {
+        // Only stage the written rows instead of the whole image.
+        auto& staging = buffer_cache.GetStagingBuffer();
+        const auto [data, staging_offset] = staging.Map(upload_size, 16);
+        const u8* guest_data = std::bit_cast<const u8*>(image_addr);
+        u64 offset = 0;
+        for (auto& copy : image_copy) {
+            const u64 row_bytes = u64(copy.bufferRowLength) * info.num_bits / 8;
+            const u64 size = row_bytes * copy.imageExtent.height;
+            std::memcpy(data + offset, guest_data + copy.bufferOffset, size);
+            copy.bufferOffset = staging_offset + offset;
+            offset += size;
+        }
+        staging.Commit();
+        buffer = staging.Handle();
     }
 
     cmdbuf.copyBufferToImage(buffer, image.image, vk::ImageLayout::eTransferDstOptimal, image_copy);
-    image.flags &= ~ImageFlagBits::Dirty;
 }
 
 vk::Sampler TextureCache::GetSampler(const AmdGpu::Sampler& sampler) {
@@ -465,6 +716,7 @@ void TextureCache::RegisterImage(ImageId image_id) {
     ASSERT_MSG(False(image.flags & ImageFlagBits::Registered),
                "Trying to register an already registered image");
     image.flags |= ImageFlagBits::Registered;
+    GpuStats::Instance().Add(Stat::ResidentImageBytes, image.image.AllocationSize());
     ForEachPage(image.cpu_addr, image.info.guest_size_bytes,
                 [this, image_id](u64 page) { page_table[page].push_back(image_id); });
 }
@@ -474,6 +726,7 @@ void TextureCache::UnregisterImage(ImageId image_id) {
     ASSERT_MSG(True(image.flags & ImageFlagBits::Registered),
                "Trying to unregister an already registered image");
     image.flags &= ~ImageFlagBits::Registered;
+    GpuStats::Instance().Sub(Stat::ResidentImageBytes, image.image.AllocationSize());
     ForEachPage(image.cpu_addr, image.info.guest_size_bytes, [this, image_id](u64 page) {
         const auto page_it = page_table.find(page);
         if (page_it == nullptr) {
@@ -493,6 +746,12 @@ void TextureCache::UnregisterImage(ImageId image_id) {
 void TextureCache::TrackImage(ImageId image_id) {
     auto& image = slot_images[image_id];
     if (True(image.flags & ImageFlagBits::Tracked)) {
+        // Protect the pages written by the guest again.
+        image.untracked_pages.ForEachRun<true>([&](size_t first_page, size_t num_pages) {
+            tracker.UpdatePagesCachedCount(image.PageAddress(first_page),
+                                           num_pages << ImagePageMask::PageBits, 1);
+        });
+        image.untracked_pages.Clear();
         return;
     }
     image.flags |= ImageFlagBits::Tracked;
@@ -505,7 +764,40 @@ void TextureCache::UntrackImage(ImageId image_id) {
         return;
     }
     image.flags &= ~ImageFlagBits::Tracked;
-    tracker.UpdatePagesCachedCount(image.cpu_addr, image.info.guest_size_bytes, -1);
+    if (image.untracked_pages.Empty()) {
+        tracker.UpdatePagesCachedCount(image.cpu_addr, image.info.guest_size_bytes, -1);
+    } else {
+        // Pages written by the guest were already untracked.
+        image.untracked_pages.ForEachRun<false>([&](size_t first_page, size_t num_pages) {
+            tracker.UpdatePagesCachedCount(image.PageAddress(first_page),
+                                           num_pages << ImagePageMask::PageBits, -1);
+        });
+        image.untracked_pages.Clear();
+    }
+    if (image.SupportsPartialUpload()) {
+        image.upload_pages.SetAll();
+    }
+}
+
+void TextureCache::UntrackImagePages(Image& image, VAddr addr, size_t size) {
+    const size_t first_page = image.PageIndex(std::max(addr, image.cpu_addr));
+    const size_t last_page = image.PageIndex(std::min(addr + size, image.cpu_addr_end) - 1);
+    size_t run_begin = first_page;
+    const auto untrack_run = [&](size_t run_end) {
+        if (run_end != run_begin) {
+            tracker.UpdatePagesCachedCount(image.PageAddress(run_begin),
+                                           (run_end - run_begin) << ImagePageMask::PageBits, -1);
+        }
+    };
+    for (size_t page = first_page; page <= last_page; ++page) {
+        image.upload_pages.Set(page);
+        if (!image.untracked_pages.Set(page)) {
+            // Page was untracked by an earlier write.
+            untrack_run(page);
+            run_begin = page + 1;
+        }
+    }
+    untrack_run(last_page + 1);
 }
 
 void TextureCache::DeleteImage(ImageId image_id) {
@@ -56,6 +56,10 @@ public:
     /// Evicts any images that overlap the unmapped range.
     void UnmapMemory(VAddr cpu_addr, size_t size);
 
+    /// Frees least recently used images that were not accessed for at least min_age ticks until
+    /// bytes_to_free bytes are released. Returns the number of bytes freed.
+    u64 EvictImages(u64 bytes_to_free, u64 min_age);
+
     /// Retrieves the image handle of the image with the provided attributes.
     [[nodiscard]] ImageId FindImage(const ImageInfo& info, FindFlags flags = {});
 
@@ -73,7 +77,10 @@ public:
     /// Updates image contents if it was modified by CPU.
     void UpdateImage(ImageId image_id, Vulkan::Scheduler* custom_scheduler = nullptr) {
         Image& image = slot_images[image_id];
-        TrackImage(image_id);
+        {
+            std::scoped_lock lock{mutex};
+            TrackImage(image_id);
+        }
         RefreshImage(image, custom_scheduler);
     }
 
@@ -199,6 +206,13 @@ private:
     /// Stop tracking CPU reads and writes for image
     void UntrackImage(ImageId image_id);
 
+    /// Stop tracking CPU writes to the pages of the image that were just written.
+    void UntrackImagePages(Image& image, VAddr addr, size_t size);
+
+    /// Reuploads only the pages of the image that were written by the CPU.
+    void RefreshImagePages(Image& image, const ImagePageMask& upload_pages,
+                           Vulkan::Scheduler* custom_scheduler);
+
     /// Removes the image and any views/surface metas that reference it.
     void DeleteImage(ImageId image_id);
 
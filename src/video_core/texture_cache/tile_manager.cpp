@@ -1,6 +1,10 @@
 // SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
 // SPDX-License-Identifier: GPL-2.0-or-later
 
+#include "common/config.h"
+#include "common/div_ceil.h"
+#include "common/thread_worker.h"
+#include "video_core/gpu_stats.h"
 #include "video_core/renderer_vulkan/vk_instance.h"
 #include "video_core/renderer_vulkan/vk_scheduler.h"
 #include "video_core/renderer_vulkan/vk_shader_util.h"
@@ -13,6 +17,8 @@
 #include "video_core/host_shaders/detile_m8x1_comp.h"
 #include "video_core/host_shaders/detile_m8x2_comp.h"
 
+#include <latch>
+#include <thread>
 #include <boost/container/static_vector.hpp>
 #include <magic_enum.hpp>
 #include <vk_mem_alloc.h>
@@ -170,6 +176,239 @@ void ConvertTileToLinear(u8* dst, const u8* src, u32 width, u32 height, bool is_
     }
 }
 
+namespace {
+
+// Texels above this amount of data are detiled by multiple threads.
+constexpr u64 ParallelDetileSize = 256_KB;
+constexpr u64 DetileTaskSize = 128_KB;
+
+constexpr u32 MicroTileDim = 8;
+constexpr u32 MicroTileTexels = MicroTileDim * MicroTileDim;
+
+// Linear position (row * 8 + col) of every texel of a micro tile, indexed by its position in
+// memory. This is the same morton order encoded by the rmort table of the detile shaders.
+constexpr std::array<u8, MicroTileTexels> MicroTileLinear = [] {
+    std::array<u8, MicroTileTexels> table{};
+    for (u32 i = 0; i < MicroTileTexels; ++i) {
+        const u32 col = (i & 1) | ((i >> 1) & 2) | ((i >> 2) & 4);
+        const u32 row = ((i >> 1) & 1) | ((i >> 2) & 2) | ((i >> 3) & 4);
+        table[i] = static_cast<u8>(row * MicroTileDim + col);
+    }
+    return table;
+}();
+
+// Texels of a micro tile row come in horizontally adjacent pairs, this holds the memory
+// position of the first texel of each pair.
+constexpr std::array<std::array<u8, MicroTileDim / 2>, MicroTileDim> MicroTileRowPairs = [] {
+    std::array<std::array<u8, MicroTileDim / 2>, MicroTileDim> table{};
+    for (u32 i = 0; i < MicroTileTexels; i += 2) {
+        const u32 pos = MicroTileLinear[i];
+        table[pos / MicroTileDim][(pos % MicroTileDim) / 2] = static_cast<u8>(i);
+    }
+    return table;
+}();
+
+u32 GetTexelBytes(DetilerType type) {
+    switch (type) {
+    case DetilerType::Micro8x1:
+        return 1;
+    case DetilerType::Micro8x2:
+        return 2;
+    case DetilerType::Micro32x1:
+        return 4;
+    case DetilerType::Micro32x2:
+        return 8;
+    case DetilerType::Micro32x4:
+        return 16;
+    default:
+        UNREACHABLE();
+    }
+}
+
+/// Mip level of a byte offset in the tiled data, computed the same way as in the shaders.
+u32 GetMipOfOffset(const DetilerParams& params, u64 offset) {
+    u32 mip = 0;
+    for (u32 m = 0; m < params.num_levels; ++m) {
+        mip += offset >= params.sizes[m] ? 1 : 0;
+    }
+    return mip;
+}
+
+u64 GetTilesPerPitch(const DetilerParams& params, u32 mip) {
+    return std::max((params.pitch0 >> mip) / MicroTileDim, 1U);
+}
+
+/// Detiles a range of micro tiles whose texels are stored in morton order.
+template <u32 TexelBytes>
+void DetileMorton(std::span<u8> dst, const u8* src, const DetilerParams& params, u64 first_tile,
+                  u64 last_tile) {
+    constexpr u32 TileBytes = MicroTileTexels * TexelBytes;
+    constexpr u32 PairBytes = TexelBytes * 2;
+    constexpr u32 RowBytes = MicroTileDim * TexelBytes;
+    // The shaders process 32-bit words at least, mips are resolved per word.
+    constexpr u32 ElementBytes = std::max(TexelBytes, 4U);
+
+    for (u64 tile = first_tile; tile < last_tile; ++tile) {
+        const u8* tile_src = src + tile * TileBytes;
+        const u64 tile_offset = tile * TileBytes;
+        const u32 mip = GetMipOfOffset(params, tile_offset);
+
+        if (mip == GetMipOfOffset(params, tile_offset + TileBytes - ElementBytes)) {
+            const u64 tiles_per_pitch = GetTilesPerPitch(params, mip);
+            const u64 tile_x = tile % tiles_per_pitch;
+            const u64 tile_y = tile / tiles_per_pitch;
+            const u64 row_pitch = tiles_per_pitch * RowBytes;
+            u64 dst_offset = tile_y * MicroTileDim * row_pitch + tile_x * RowBytes;
+            for (u32 row = 0; row < MicroTileDim; ++row, dst_offset += row_pitch) {
+                const auto& pairs = MicroTileRowPairs[row];
+                if (dst_offset + RowBytes <= dst.size()) {
+                    // Fixed size copies, these become plain vector moves.
+                    u8* dst_row = dst.data() + dst_offset;
+                    for (u32 pair = 0; pair < pairs.size(); ++pair) {
+                        std::memcpy(dst_row + pair * PairBytes,
+                                    tile_src + pairs[pair] * TexelBytes, PairBytes);
+                    }
+                    continue;
+                }
+                for (u32 pair = 0; pair < pairs.size(); ++pair) {
+                    const u64 offset = dst_offset + pair * PairBytes;
+                    if (offset + PairBytes <= dst.size()) {
+                        std::memcpy(dst.data() + offset, tile_src + pairs[pair] * TexelBytes,
+                                    PairBytes);
+                    }
+                }
+            }
+            continue;
+        }
+
+        // The tile straddles a mip boundary, place each element on its own.
+        for (u32 texel = 0; texel < MicroTileTexels; texel += ElementBytes / TexelBytes) {
+            const u32 element_mip = GetMipOfOffset(params, tile_offset + texel * TexelBytes);
+            const u64 tiles_per_pitch = GetTilesPerPitch(params, element_mip);
+            const u32 pos = MicroTileLinear[texel];
+            const u64 dst_texel = ((tile / tiles_per_pitch) * MicroTileDim + pos / MicroTileDim) *
+                                      tiles_per_pitch * MicroTileDim +
+                                  (tile % tiles_per_pitch) * MicroTileDim + pos % MicroTileDim;
+            const u64 offset = dst_texel * TexelBytes;
+            if (offset + ElementBytes <= dst.size()) {
+                std::memcpy(dst.data() + offset, tile_src + texel * TexelBytes, ElementBytes);
+            }
+        }
+    }
+}
+
+/// Detiles a range of 8bpp micro tiles, mirroring the word shuffle done by detile_m8x1.
+void Detile8x1(std::span<u8> dst, const u8* src, const DetilerParams& params, u64 first_tile,
+               u64 last_tile) {
+    constexpr u32 TileWords = MicroTileTexels / sizeof(u32);
+    const auto store = [&](u32 i, u64 tile, u32 mip, u32 value) {
+        const u64 tiles_per_pitch = GetTilesPerPitch(params, mip);
+        const u32 col = (i >> 2) & 1;
+        const u32 row = (i % 4) + 4 * (i >> 3);
+        const u64 dst_word = (tile % tiles_per_pitch) * 2 + col +
+                             ((tile / tiles_per_pitch) * MicroTileDim + row) * tiles_per_pitch * 2;
+        if ((dst_word + 1) * sizeof(u32) <= dst.size()) {
+            std::memcpy(dst.data() + dst_word * sizeof(u32), &value, sizeof(u32));
+        }
+    };
+
+    for (u64 tile = first_tile; tile < last_tile; ++tile) {
+        std::array<u32, TileWords> words;
+        std::memcpy(words.data(), src + tile * sizeof(words), sizeof(words));
+        // Every word is merged with the other half of its neighbour.
+        std::array<u32, TileWords> values;
+        for (u32 i = 0; i < TileWords; ++i) {
+            const u32 p0 = words[i];
+            const u32 p1 = words[i ^ 1];
+            values[i] = (i & 1) ? (p0 & 0xffff0000) | (p1 >> 16) : (p0 & 0x0000ffff) | (p1 << 16);
+        }
+
+        const u64 tile_offset = tile * sizeof(words);
+        const u32 mip = GetMipOfOffset(params, tile_offset);
+        if (mip != GetMipOfOffset(params, tile_offset + sizeof(words) - sizeof(u32))) {
+            for (u32 i = 0; i < TileWords; ++i) {
+                store(i, tile, GetMipOfOffset(params, tile_offset + i * sizeof(u32)), values[i]);
+            }
+            continue;
+        }
+
+        // Words 4n..4n+3 hold two columns of two rows, one row of the output is 2 words wide.
+        const u64 tiles_per_pitch = GetTilesPerPitch(params, mip);
+        const u64 row_pitch = tiles_per_pitch * 2 * sizeof(u32);
+        const u64 dst_offset = (tile / tiles_per_pitch) * MicroTileDim * row_pitch +
+                               (tile % tiles_per_pitch) * 2 * sizeof(u32);
+        if (dst_offset + (MicroTileDim - 1) * row_pitch + 2 * sizeof(u32) > dst.size()) {
+            for (u32 i = 0; i < TileWords; ++i) {
+                store(i, tile, mip, values[i]);
+            }
+            continue;
+        }
+        for (u32 row = 0; row < MicroTileDim; ++row) {
+            const u32 i = (row % 4) + 8 * (row / 4);
+            const std::array<u32, 2> row_words = {values[i], values[i + 4]};
+            std::memcpy(dst.data() + dst_offset + row * row_pitch, row_words.data(),
+                        sizeof(row_words));
+        }
+    }
+}
+
+void DetileRange(std::span<u8> dst, const u8* src, DetilerType type, const DetilerParams& params,
+                 u64 first_tile, u64 last_tile) {
+    switch (type) {
+    case DetilerType::Micro8x1:
+        return Detile8x1(dst, src, params, first_tile, last_tile);
+    case DetilerType::Micro8x2:
+        return DetileMorton<2>(dst, src, params, first_tile, last_tile);
+    case DetilerType::Micro32x1:
+        return DetileMorton<4>(dst, src, params, first_tile, last_tile);
+    case DetilerType::Micro32x2:
+        return DetileMorton<8>(dst, src, params, first_tile, last_tile);
+    case DetilerType::Micro32x4:
+        return DetileMorton<16>(dst, src, params, first_tile, last_tile);
+    default:
+        UNREACHABLE();
+    }
+}
+
+DetilerParams MakeDetilerParams(const Image& image) {
+    DetilerParams params;
+    params.pitch0 = image.info.pitch >> (image.info.props.is_block ? 2u : 0u);
+    params.num_levels = image.info.resources.levels;
+
+    ASSERT(image.info.resources.levels <= 14);
+    std::memset(&params.sizes, 0, sizeof(params.sizes));
+    for (int m = 0; m < image.info.resources.levels; ++m) {
+        params.sizes[m] = image.info.mips_layout[m].size * image.info.resources.layers +
+                          (m > 0 ? params.sizes[m - 1] : 0);
+    }
+    return params;
+}
+
+} // Anonymous namespace
+
+void DetileMicroTiled(std::span<u8> dst, const u8* src, DetilerType type,
+                      const DetilerParams& params, Common::ThreadWorker* worker) {
+    const u64 tile_bytes = MicroTileTexels * GetTexelBytes(type);
+    const u64 num_tiles = dst.size() / tile_bytes;
+    if (!worker || dst.size() < ParallelDetileSize) {
+        DetileRange(dst, src, type, params, 0, num_tiles);
+        return;
+    }
+
+    const u64 tiles_per_task = DetileTaskSize / tile_bytes;
+    const u64 num_tasks = Common::DivCeil(num_tiles, tiles_per_task);
+    std::latch done{static_cast<std::ptrdiff_t>(num_tasks)};
+    for (u64 task = 0; task < num_tasks; ++task) {
+        const u64 first_tile = task * tiles_per_task;
+        const u64 last_tile = std::min(first_tile + tiles_per_task, num_tiles);
+        worker->QueueWork([&, first_tile, last_tile] {
+            DetileRange(dst, src, type, params, first_tile, last_tile);
+            done.count_down();
+        });
+    }
+    done.wait();
+}
+
 vk::Format DemoteImageFormatForDetiling(vk::Format format) {
     switch (format) {
     case vk::Format::eR8Unorm:
@@ -223,33 +462,32 @@ vk::Format DemoteImageFormatForDetiling(vk::Format format) {
     return format;
 }
 
-const DetilerContext* TileManager::GetDetiler(const Image& image) const {
+std::optional<DetilerType> TileManager::GetDetilerType(const Image& image) const {
     const auto format = DemoteImageFormatForDetiling(image.info.pixel_format);
 
     if (image.info.tiling_mode == AmdGpu::TilingMode::Texture_MicroTiled) {
         switch (format) {
         case vk::Format::eR8Uint:
-            return &detilers[DetilerType::Micro8x1];
+            return DetilerType::Micro8x1;
         case vk::Format::eR8G8Uint:
-            return &detilers[DetilerType::Micro8x2];
+            return DetilerType::Micro8x2;
         case vk::Format::eR32Uint:
-            return &detilers[DetilerType::Micro32x1];
+            return DetilerType::Micro32x1;
         case vk::Format::eR32G32Uint:
-            return &detilers[DetilerType::Micro32x2];
+            return DetilerType::Micro32x2;
         case vk::Format::eR32G32B32A32Uint:
-            return &detilers[DetilerType::Micro32x4];
+            return DetilerType::Micro32x4;
         default:
-            return nullptr;
+            return std::nullopt;
         }
     }
-    return nullptr;
+    return std::nullopt;
 }
 
-struct DetilerParams {
-    u32 num_levels;
-    u32 pitch0;
-    u32 sizes[14];
-};
+const DetilerContext* TileManager::GetDetiler(const Image& image) const {
+    const auto type = GetDetilerType(image);
+    return type ? &detilers[*type] : nullptr;
+}
 
 TileManager::TileManager(const Vulkan::Instance& instance, Vulkan::Scheduler& scheduler)
     : instance{instance}, scheduler{scheduler} {
@@ -334,6 +572,9 @@ TileManager::TileManager(const Vulkan::Instance& instance, Vulkan::Scheduler& sc
         // Once pipeline is compiled, we don't need the shader module anymore
         instance.GetDevice().destroyShaderModule(module);
     }
+
+    const u32 num_threads = std::max(std::thread::hardware_concurrency() / 2, 1U);
+    host_worker = std::make_unique<Common::ThreadWorker>(num_threads, "shadPS4:Detiler");
 }
 
 TileManager::~TileManager() = default;
@@ -435,20 +676,11 @@ std::pair<vk::Buffer, u32> TileManager::TryDetile(vk::Buffer in_buffer, u32 in_o
             .pBufferInfo = &output_buffer_info,
         },
     };
+    scheduler.InvalidateDescriptors(vk::PipelineBindPoint::eCompute);
     cmdbuf.pushDescriptorSetKHR(vk::PipelineBindPoint::eCompute, *detiler->pl_layout, 0,
                                 set_writes);
 
-    DetilerParams params;
-    params.pitch0 = image.info.pitch >> (image.info.props.is_block ? 2u : 0u);
-    params.num_levels = image.info.resources.levels;
-
-    ASSERT(image.info.resources.levels <= 14);
-    std::memset(&params.sizes, 0, sizeof(params.sizes));
-    for (int m = 0; m < image.info.resources.levels; ++m) {
-        params.sizes[m] = image.info.mips_layout[m].size * image.info.resources.layers +
-                          (m > 0 ? params.sizes[m - 1] : 0);
-    }
-
+    const DetilerParams params = MakeDetilerParams(image);
     cmdbuf.pushConstants(*detiler->pl_layout, vk::ShaderStageFlagBits::eCompute, 0u, sizeof(params),
                          &params);
 
@@ -467,7 +699,21 @@ std::pair<vk::Buffer, u32> TileManager::TryDetile(vk::Buffer in_buffer, u32 in_o
                            vk::PipelineStageFlagBits::eTransfer, vk::DependencyFlagBits::eByRegion,
                            {}, post_barrier, {});
 
+    GpuStats::Instance().Add(Stat::ImagesDetiledGpu);
     return {out_buffer.first, 0};
 }
 
+bool TileManager::CanDetileOnHost(const Image& image) const {
+    return Config::isHostDetilingEnabled() && image.info.props.is_tiled &&
+           GetDetilerType(image).has_value();
+}
+
+void TileManager::DetileOnHost(std::span<u8> dst, const Image& image) {
+    const auto type = GetDetilerType(image);
+    ASSERT(type.has_value());
+    const auto* src = reinterpret_cast<const u8*>(image.info.guest_address);
+    DetileMicroTiled(dst, src, *type, MakeDetilerParams(image), host_worker.get());
+    GpuStats::Instance().Add(Stat::ImagesDetiledHost);
+}
+
 } // namespace VideoCore
@@ -3,10 +3,18 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
+#include <span>
+
 #include "common/types.h"
 #include "video_core/buffer_cache/buffer.h"
 #include "video_core/texture_cache/image.h"
 
+namespace Common {
+class ThreadWorker;
+}
+
 namespace VideoCore {
 
 class TextureCache;
@@ -32,6 +40,17 @@ struct DetilerContext {
     vk::UniquePipelineLayout pl_layout;
 };
 
+struct DetilerParams {
+    u32 num_levels;
+    u32 pitch0;
+    u32 sizes[14];
+};
+
+/// Detiles micro tiled image data on the host. The output is identical to the one produced by
+/// the detile compute shaders, work is split across the worker threads if one is provided.
+void DetileMicroTiled(std::span<u8> dst, const u8* src, DetilerType type,
+                      const DetilerParams& params, Common::ThreadWorker* worker = nullptr);
+
 class TileManager {
 public:
     using ScratchBuffer = std::pair<vk::Buffer, VmaAllocation>;
@@ -41,11 +60,23 @@ public:
 
     std::pair<vk::Buffer, u32> TryDetile(vk::Buffer in_buffer, u32 in_offset, Image& image);
 
+    /// Returns true if the image can be detiled by the host while its data is being staged.
+    bool CanDetileOnHost(const Image& image) const;
+
+    /// Writes the detiled contents of the image in guest memory to the provided buffer.
+    void DetileOnHost(std::span<u8> dst, const Image& image);
+
+    /// Returns the pool of host threads used for detiling, it may be shared by other host work.
+    [[nodiscard]] Common::ThreadWorker* HostWorker() const noexcept {
+        return host_worker.get();
+    }
+
     ScratchBuffer AllocBuffer(u32 size, bool is_storage = false);
     void Upload(ScratchBuffer buffer, const void* data, size_t size);
     void FreeBuffer(ScratchBuffer buffer);
 
 private:
+    std::optional<DetilerType> GetDetilerType(const Image& image) const;
     const DetilerContext* GetDetiler(const Image& image) const;
 
 private:
@@ -53,6 +84,7 @@ private:
     Vulkan::Scheduler& scheduler;
     vk::UniqueDescriptorSetLayout desc_layout;
     std::array<DetilerContext, DetilerType::Max> detilers;
+    std::unique_ptr<Common::ThreadWorker> host_worker;
 };
 
 } // namespace VideoCore
@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: Copyright 2024 shadPS4 Emulator Project
+// SPDX-License-Identifier: GPL-2.0-or-later
+
+#include <cstdio>
+#include <vector>
+#include "common/arena.h"
+
+namespace {
+
+int num_failures = 0;
+
+void Check(bool condition, const char* what) {
+    if (!condition) {
+        std::fprintf(stderr, "FAILED: %s\n", what);
+        ++num_failures;
+    }
+}
+
+// A translation of a large shader reserves its instruction list up front, which does not fit a
+// regular chunk. Repeating it after a reset must reuse the oversized chunk.
+void TestRepeatedLargeAllocation() {
+    Common::MonotonicArena arena{64_KB};
+    for (int round = 0; round < 4; ++round) {
+        arena.Reset();
+        std::pmr::vector<u8> small(1_KB, &arena);
+        std::pmr::vector<u8> large(256_KB, &arena);
+        std::pmr::vector<u8> more(32_KB, &arena);
+        if (round > 0) {
+            Check(arena.GetStats().num_chunk_allocations == 0, "large allocation reuses chunks");
+        }
+    }
+}
+
+// Allocations that grow from round to round only take new chunks while they grow.
+void TestGrowingAllocation() {
+    Common::MonotonicArena arena{64_KB};
+    for (size_t size : {128_KB, 256_KB, 512_KB}) {
+        arena.Reset();
+        std::pmr::vector<u8> data(size, &arena);
+    }
+    arena.Reset();
+    std::pmr::vector<u8> data(512_KB, &arena);
+    Check(arena.GetStats().num_chunk_allocations == 0, "largest allocation reuses its chunk");
+}
+
+void TestAlignment() {
+    Common::MonotonicArena arena{4_KB};
+    for (size_t alignment : {8, 64, 4096}) {
+        [[maybe_unused]] void* padding = arena.allocate(1, 1);
+        void* ptr = arena.allocate(16, alignment);
+        Check(reinterpret_cast<uintptr_t>(ptr) % alignment == 0, "allocation is aligned");
+    }
+}
+
+} // Anonymous namespace
+
+int main() {
+    TestRepeatedLargeAllocation();
+    TestGrowingAllocation();
+    TestAlignment();
+    return num_failures == 0 ? 0 : 1;
+}